@@ -1,3 +1,6 @@
+#ifndef BITOPS_H
+#define BITOPS_H
+
 #ifdef CONFIG_64BIT
 #define BITS_PER_LONG 64
 #else
@@ -35,3 +38,62 @@
 #define NBITS(n) (n==0?0:NBITS32(n))
 
 #define EXTRACT_NBITS(nr, h, l) ((nr&GENMASK(h,l)) >> l)
+
+/*
+ * Fixed-width bitmaps backed by 64-bit words, independent of BITS_PER_LONG.
+ * Lookups use the compiler's count-trailing-zeros builtin so that finding
+ * the lowest set bit maps onto a single find-first-set instruction.
+ */
+#include <stdint.h>
+
+#define BITMAP_WORD_BITS        64
+#define BITMAP_WORDS(nr)        DIV_ROUND_UP(nr, BITMAP_WORD_BITS)
+
+static inline void bitmap_set(uint64_t *map, int nr)
+{
+	map[nr / BITMAP_WORD_BITS] |= 1ULL << (nr % BITMAP_WORD_BITS);
+}
+
+static inline void bitmap_clear(uint64_t *map, int nr)
+{
+	map[nr / BITMAP_WORD_BITS] &= ~(1ULL << (nr % BITMAP_WORD_BITS));
+}
+
+static inline int bitmap_test(const uint64_t *map, int nr)
+{
+	return (map[nr / BITMAP_WORD_BITS] >> (nr % BITMAP_WORD_BITS)) & 1;
+}
+
+/* Return the index of the lowest set bit, or @nbits if the map is empty */
+static inline int bitmap_first(const uint64_t *map, int nbits)
+{
+	int w;
+
+	for (w = 0; w < BITMAP_WORDS(nbits); w++)
+		if (map[w])
+			return w * BITMAP_WORD_BITS + __builtin_ctzll(map[w]);
+	return nbits;
+}
+
+/* Return the index of the lowest set bit at or after @start, or @nbits */
+static inline int bitmap_next(const uint64_t *map, int nbits, int start)
+{
+	int w = start / BITMAP_WORD_BITS;
+	uint64_t word;
+
+	if (start >= nbits)
+		return nbits;
+	/* Mask off the bits below @start in its own word */
+	word = map[w] & (~0ULL << (start % BITMAP_WORD_BITS));
+	for (;;) {
+		if (word) {
+			int nr = w * BITMAP_WORD_BITS + __builtin_ctzll(word);
+			return nr < nbits ? nr : nbits;
+		}
+		if (++w >= BITMAP_WORDS(nbits))
+			return nbits;
+		word = map[w];
+	}
+}
+
+#endif
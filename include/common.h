@@ -5,6 +5,8 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include "rbtree.h"
+#include "twheel.h"
 
 #ifndef OSCFG_H
 #include "os-cfg.h"
@@ -32,8 +34,14 @@ enum ins_opcode_t
 	READ,  // Write data to a byte on memory
 	WRITE, // Read data from a byte on memory
 	SYSCALL,
+	MEMSET,	  // Fill a block of memory with a byte
+	MEMCPY,	  // Copy a block of memory between two regions
+	READBLK,  // Read a block of memory
+	WRITEBLK, // Write a block of counting bytes to memory
 };
 
+#define NR_OPCODES (WRITEBLK + 1)
+
 /* instructions executed by the CPU */
 struct inst_t
 {
@@ -44,9 +52,21 @@ struct inst_t
 	uint32_t arg_3;
 };
 
+/* An instruction decoded once for run(): its handler and operands */
+struct op_t
+{
+	const void *handler; // Where run() dispatches it, see predecode()
+	enum ins_opcode_t opcode;
+	uint32_t arg_0;
+	uint32_t arg_1;
+	uint32_t arg_2;
+	uint32_t arg_3;
+};
+
 struct code_seg_t
 {
 	struct inst_t *text;
+	struct op_t *ops; // text decoded by predecode(), NULL until then
 	uint32_t size;
 };
 
@@ -79,7 +99,7 @@ struct pcb_t
 	uint32_t pid;		 // PID
 	uint32_t priority;	 // Default priority, this legacy process based (FIXED)
 	char path[100];
-	struct code_seg_t *code; // Code segment
+	const struct code_seg_t *code; // Code segment, shared, see load()
 	addr_t regs[10];	 // Registers, store address of allocated regions
 	uint32_t pc;		 // Program pointer, point to the next instruction
 	struct queue_t *ready_queue;
@@ -89,6 +109,9 @@ struct pcb_t
 	// Priority on execution (if supported), on-fly aka. changeable
 	// and this vale overwrites the default priority when it existed
 	uint32_t prio;
+	uint32_t mlq_boost;	  // Levels gained by aging, undone on dispatch
+	uint64_t mlq_ready_epoch; // Run queue epoch when it became ready
+	uint64_t mlq_level_epoch; // Run queue epoch when it joined its level
 #endif
 #ifdef MM_PAGING
 	struct mm_struct *mm;
@@ -103,6 +126,17 @@ struct pcb_t
 	uint32_t burst_time;
 	uint32_t arrival_time;
 	uint32_t remaining_time; // For SRTF
+	uint32_t deadline;	 // Time slot to finish by, 0 if none. For EDF
+
+	uint64_t vruntime;	 // Weighted CPU time, for the cfs policy
+	struct rb_node run_node; // Link in the cfs run tree
+	uint32_t tickets;	 // Share for stride/lottery, 0 derives it from prio
+	uint64_t pass;		 // Stride scheduling virtual time
+
+	struct tw_timer alarm;	 // Wakes the process up from settimer
+	uint32_t sleeping;	 // Off the run queue until its alarm fires
+
+	struct perf_counters *perf; // Counted while it runs, see perf.h
 };
 
 #endif
@@ -9,5 +9,14 @@
  * Otherwise, return 1. */
 int run(struct pcb_t * proc);
 
+/* Execute up to [budget] instructions of a process in one go, stopping
+ * early at the end of its code or once it went to sleep. Return the
+ * status of the last instruction, as run() does */
+int run_slice(struct pcb_t * proc, uint32_t budget);
+
+/* Decode [code]->text into [code]->ops, done by the loader once per
+ * segment before any process runs it */
+void predecode(struct code_seg_t * code);
+
 #endif
 
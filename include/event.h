@@ -0,0 +1,38 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+
+/* Kinds of events, a slot runs its timers, then its loader event and
+ * then its CPU events */
+enum event_kind {
+	EVENT_TIMER,		/* Timers fire in this slot */
+	EVENT_LOAD,		/* The loader has a process due in this slot */
+	EVENT_CPU,		/* A CPU dispatches, runs or retires a process */
+};
+
+struct event {
+	uint64_t time;		/* Time slot the event fires in */
+	enum event_kind kind;
+	int id;			/* CPU id for EVENT_CPU */
+};
+
+/* Pending events kept in a binary min-heap ordered by time, then kind,
+ * then id, so that events of one slot always fire in the same order. A
+ * zero-filled event_queue_t is a valid empty queue. */
+struct event_queue_t {
+	struct event * heap;
+	int size;
+	int capacity;
+};
+
+/* Schedule [ev], O(log n) */
+void event_push(struct event_queue_t * q, struct event ev);
+
+/* Remove the earliest event into [ev], return 0 if [q] is empty */
+int event_pop(struct event_queue_t * q, struct event * ev);
+
+/* Release the heap storage and leave [q] empty */
+void free_event_queue(struct event_queue_t * q);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "common.h"
+
+/*
+ * Program images. A program is either the text format of input/proc:
+ *   [priority] [number of instructions]
+ *   [opcode] [operands ...]
+ *   ...
+ * or a binary image compiled from it by pasm: a struct image_header and
+ * then the instructions packed as struct inst_t, in host byte order. The
+ * loader maps an image and runs its instructions in place.
+ */
+#define IMAGE_MAGIC	0x474d4950	/* "PIMG" */
+#define IMAGE_VERSION	1
+
+struct image_header {
+	uint32_t magic;
+	uint32_t version;	/* IMAGE_VERSION it was written with */
+	uint32_t priority;
+	uint32_t size;		/* Number of instructions that follow */
+};
+
+/* Parse the text program in [file] into [code], exits on error */
+void read_program(FILE * file, const char * path, uint32_t * priority,
+		struct code_seg_t * code);
+
+/* Map the image at [path] and point [code] at its instructions.
+ * Return 0 on success, 1 if [path] is not an image, exits on a broken
+ * one */
+int map_image(const char * path, uint32_t * priority, struct code_seg_t * code);
+
+/* Unmap the image [code] was pointed at by map_image() */
+void unmap_image(const struct code_seg_t * code);
+
+/* Write [code] as an image to [path], return 0 on success */
+int write_image(const char * path, uint32_t priority,
+		const struct code_seg_t * code);
+
+#endif
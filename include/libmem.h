@@ -23,3 +23,7 @@ int liballoc(struct pcb_t *, uint32_t, uint32_t);
 int libfree(struct pcb_t *, uint32_t);
 int libread(struct pcb_t*, uint32_t, uint32_t, uint32_t*);
 int libwrite(struct pcb_t*, BYTE, uint32_t, uint32_t);
+int libreadblk(struct pcb_t*, uint32_t, uint32_t, uint32_t);
+int libwriteblk(struct pcb_t*, BYTE, uint32_t, uint32_t, uint32_t);
+int libmemset(struct pcb_t*, BYTE, uint32_t, uint32_t, uint32_t);
+int libmemcpy(struct pcb_t*, uint32_t, uint32_t, uint32_t, uint32_t);
@@ -3,7 +3,17 @@
 
 #include "common.h"
 
+/* Create a process running the program at [path]. Processes loaded from
+ * the same path share one code segment */
 struct pcb_t * load(const char * path);
 
+/* Same as load() with a given [pid], for loaders that do not create the
+ * processes in PID order. Safe to call from several threads */
+struct pcb_t * load_pid(const char * path, uint32_t pid);
+
+/* Drop the reference of a finished process to its code segment, which is
+ * freed with the last one */
+void release_code(const struct code_seg_t * code);
+
 #endif
 
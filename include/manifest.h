@@ -0,0 +1,62 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "common.h"
+#include <stdio.h>
+
+/*
+ * Process manifests, the list of processes to load. A manifest is either
+ * text, one process per line as in the configure file:
+ *   [start time] [program] [priority] [deadline]
+ * or a binary manifest compiled from it by pasm -m: a struct
+ * manifest_header, the program names and then fixed size records, in
+ * host byte order. Both are read one record at a time, so the loader
+ * never holds more than the processes it is about to load.
+ */
+#define MANIFEST_MAGIC		0x464e4d50	/* "PMNF" */
+#define MANIFEST_VERSION	1
+#define MANIFEST_NAME		32	/* Bytes of a program name, with its NUL */
+
+struct manifest_header {
+	uint32_t magic;
+	uint32_t version;	/* MANIFEST_VERSION it was written with */
+	uint32_t nr_programs;	/* Names of MANIFEST_NAME bytes that follow */
+	uint32_t pad;
+	uint64_t count;		/* Records that follow the names */
+};
+
+struct manifest_record {
+	uint32_t start_time;
+	uint32_t program;	/* Index in the names */
+	uint32_t prio;
+	uint32_t deadline;	/* Relative to the start time, 0 for none */
+};
+
+/* A process as the loader sees it */
+struct ld_record {
+	unsigned long start_time;
+	unsigned long prio;
+	unsigned long deadline;	/* Absolute, 0 if the process has none */
+	char path[100];		/* input/proc/[program] */
+};
+
+struct manifest;
+
+/* Read the manifest at [path], text or binary. Exits if it is missing */
+struct manifest * manifest_open(const char * path);
+
+/* Read [count] process lines from [file], the rest of the configure file
+ * at [path], which stays open until manifest_close() */
+struct manifest * manifest_inline(FILE * file, const char * path, int count);
+
+/* Read the next process into [rec]. Return 0 on success, 1 past the last
+ * one, exits on a broken manifest */
+int manifest_next(struct manifest * m, struct ld_record * rec);
+
+void manifest_close(struct manifest * m);
+
+/* Compile the text manifest at [src] to a binary one at [dst], return 0
+ * on success */
+int compile_manifest(const char * src, const char * dst);
+
+#endif
@@ -121,7 +121,16 @@ int __alloc(struct pcb_t *caller, int vmaid, int rgid, int size, int *alloc_addr
 int __free(struct pcb_t *caller, int vmaid, int rgid);
 int __read(struct pcb_t *caller, int vmaid, int rgid, int offset, BYTE *data);
 int __write(struct pcb_t *caller, int vmaid, int rgid, int offset, BYTE value);
+int __readblk(struct pcb_t *caller, int vmaid, int rgid, int offset, int size);
+int __writeblk(struct pcb_t *caller, int vmaid, int rgid, int offset, int size, BYTE value);
+int __memset(struct pcb_t *caller, int vmaid, int rgid, int offset, int size, BYTE value);
+int __memcpy(struct pcb_t *caller, int vmaid, int srcid, int dstid, int offset, int size);
+int pg_getblk(struct mm_struct *mm, int addr, BYTE *buf, int len, struct pcb_t *caller);
+int pg_setblk(struct mm_struct *mm, int addr, const BYTE *buf, BYTE fill, int len,
+              struct pcb_t *caller);
 int init_mm(struct mm_struct *mm, struct pcb_t *caller);
+void free_mm(struct mm_struct *mm);
+int free_pcb_memph(struct pcb_t *caller);
 
 /* VM prototypes */
 int pgalloc(struct pcb_t *proc, uint32_t size, uint32_t reg_index);
@@ -149,6 +158,9 @@ int MEMPHY_get_freefp(struct memphy_struct *mp, int *fpn);
 int MEMPHY_put_freefp(struct memphy_struct *mp, int fpn);
 int MEMPHY_read(struct memphy_struct * mp, int addr, BYTE *value);
 int MEMPHY_write(struct memphy_struct * mp, int addr, BYTE data);
+int MEMPHY_read_blk(struct memphy_struct * mp, int addr, BYTE *buf, int len);
+int MEMPHY_write_blk(struct memphy_struct * mp, int addr, const BYTE *buf,
+                     BYTE fill, int len);
 int MEMPHY_dump(struct memphy_struct * mp);
 int init_memphy(struct memphy_struct *mp, int max_size, int randomflg);
 
@@ -8,7 +8,10 @@
 //#define MM_FIXED_MEMSZ
 //#define VMDBG 1
 //#define MMDBG 1
+/* make NODUMP=1 leaves out the memory dumps, for large workloads */
+#ifndef NODUMP
 #define IODUMP 1
 #define PAGETBL_DUMP 1
+#endif
 
 #endif
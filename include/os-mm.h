@@ -56,6 +56,9 @@ struct mm_struct {
 
    /* list of free page */
    struct pgn_t *fifo_pgn;
+
+   /* CPU whose TLB may hold its translations, -1 if none */
+   int tlb_cpu;
 };
 
 /*
@@ -0,0 +1,67 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include "common.h"
+
+/* Events counted besides the instructions retired by opcode */
+enum perf_event {
+	PERF_BUSY,		/* Slots spent running a process */
+	PERF_DISPATCH,		/* Processes dispatched */
+	PERF_PREEMPT,		/* Processes put back at the end of a quantum */
+	PERF_PGFAULT,		/* Pages not present on access */
+	PERF_SWAPIN,		/* Pages brought back from MEMSWAP */
+	PERF_SWAPOUT,		/* Pages evicted to make room */
+	PERF_TLB_HIT,
+	PERF_TLB_MISS,
+	PERF_SYSCALL,		/* System calls made */
+	NR_PERF_EVENTS,
+};
+
+struct perf_counters {
+	uint64_t insns[NR_OPCODES];
+	uint64_t events[NR_PERF_EVENTS];
+};
+
+/*
+ * Every CPU counts into its own cache line aligned slot, which only the
+ * thread running that CPU writes, and a process counts into its pcb while
+ * it runs, which is on one CPU at a time. So counting takes no lock nor
+ * atomic. A CPU selects its slot with perf_switch() before each slot, the
+ * memory and syscall code then count into the slot of the CPU they run
+ * on. Nothing is counted outside of a CPU.
+ */
+extern __thread struct perf_counters * perf_cur;
+
+static inline void perf_count(struct pcb_t * proc, enum perf_event ev) {
+	if (perf_cur == NULL)
+		return;
+	perf_cur->events[ev]++;
+	if (proc != NULL && proc->perf != NULL)
+		proc->perf->events[ev]++;
+}
+
+static inline void perf_insn(struct pcb_t * proc, enum ins_opcode_t opcode) {
+	if (perf_cur == NULL)
+		return;
+	perf_cur->insns[opcode]++;
+	if (proc->perf != NULL)
+		proc->perf->insns[opcode]++;
+}
+
+/* Allocate zeroed slots for [nr_cpus] CPUs */
+void perf_init(int nr_cpus);
+
+/* Count into the slot of [cpu] on this thread */
+void perf_switch(int cpu);
+
+/* Keep the counters of [proc], which finished, for the report */
+void perf_exit(struct pcb_t * proc);
+
+/* Print the counters of every CPU and finished process, [run_slots]
+ * being the length of the run, and write them to [csv] as well unless
+ * NULL */
+void perf_report(uint64_t run_slots, const char * csv);
+
+void perf_free(void);
+
+#endif
@@ -4,11 +4,16 @@
 
 #include "common.h"
 
-#define MAX_QUEUE_SIZE 10
+/* Initial ring capacity, the ring doubles whenever it fills up */
+#define QUEUE_INIT_CAPACITY 16
 
+/* FIFO of processes kept in a growable circular buffer. A zero-filled
+ * queue_t is a valid empty queue. */
 struct queue_t {
-	struct pcb_t * proc[MAX_QUEUE_SIZE];
+	struct pcb_t ** proc;	/* Ring storage, capacity is a power of two */
+	int head;		/* Index of the oldest process */
 	int size;
+	int capacity;
 };
 
 void enqueue(struct queue_t * q, struct pcb_t * proc);
@@ -17,5 +22,41 @@ struct pcb_t * dequeue(struct queue_t * q);
 
 int empty(struct queue_t * q);
 
+/* The [i]-th oldest process of [q], 0 <= i < q->size */
+struct pcb_t * queue_at(struct queue_t * q, int i);
+
+/* Release the ring storage and leave [q] empty */
+void free_queue(struct queue_t * q);
+
+/* Priority queue of processes kept in a binary min-heap. Processes with
+ * equal keys come out in insertion order. A zero-filled prio_queue_t is a
+ * valid empty queue. */
+struct pq_node {
+	uint64_t key;		/* Smaller key is served first */
+	uint64_t seq;		/* Insertion stamp, breaks ties FIFO */
+	struct pcb_t * proc;
+};
+
+struct prio_queue_t {
+	struct pq_node * heap;
+	int size;
+	int capacity;
+	uint64_t seq;
+};
+
+/* Insert [proc] with priority [key], O(log n) */
+void pq_enqueue(struct prio_queue_t * q, struct pcb_t * proc, uint64_t key);
+
+/* Remove and return the process with the smallest key, O(log n) */
+struct pcb_t * pq_dequeue(struct prio_queue_t * q);
+
+/* Return the process with the smallest key without removing it */
+struct pcb_t * pq_peek(struct prio_queue_t * q);
+
+int pq_empty(struct prio_queue_t * q);
+
+/* Release the heap storage and leave [q] empty */
+void free_pq(struct prio_queue_t * q);
+
 #endif
 
@@ -0,0 +1,43 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <stddef.h>
+
+/* Intrusive red-black tree: embed a struct rb_node in the element and get
+ * the element back with rb_entry(). Insert and erase are O(log n), the
+ * leftmost node is cached so rb_first() is O(1). A zero-filled rb_root is
+ * a valid empty tree. */
+#define RB_RED		0
+#define RB_BLACK	1
+
+struct rb_node {
+        struct rb_node * parent;
+        struct rb_node * left;
+        struct rb_node * right;
+        int color;
+};
+
+struct rb_root {
+        struct rb_node * node;
+        struct rb_node * leftmost;	/* Smallest node, NULL if empty */
+        int count;
+};
+
+#define rb_entry(ptr, type, member) \
+        ((type *)((char *)(ptr) - offsetof(type, member)))
+
+/* Insert [node] ordered by [less], equal nodes go after the existing ones */
+void rb_insert(struct rb_root * root, struct rb_node * node,
+               int (*less)(const struct rb_node *, const struct rb_node *));
+
+/* Unlink [node], which must be in [root] */
+void rb_erase(struct rb_root * root, struct rb_node * node);
+
+/* In-order successor of [node], NULL for the last one */
+struct rb_node * rb_next(const struct rb_node * node);
+
+static inline struct rb_node * rb_first(const struct rb_root * root) {
+        return root->leftmost;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+/*
+ * Record/replay of the CPU schedule. In both modes the CPUs take turns to
+ * run their time slot, so that a slot is a sequence of whole CPU steps.
+ * Recording logs that sequence, with the process each step dispatched;
+ * replaying makes the CPUs take their turns in the logged order and stops
+ * the run as soon as a step dispatches something else.
+ */
+#define RR_OFF		0
+#define RR_RECORD	1
+#define RR_REPLAY	2
+
+/* Open the log at [path] for [mode], exits on error */
+void rr_open(const char * path, int mode, int num_cpus);
+
+/* Wait for the turn of [cpu] to run its time slot */
+void rr_begin(int cpu);
+
+/* End the turn of [cpu], which dispatched [pid] (0 if none) and stopped
+ * if [stopped] */
+void rr_end(int cpu, uint32_t pid, int stopped);
+
+/* Flush and close the log */
+void rr_close(void);
+
+#endif
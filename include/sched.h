@@ -1,28 +1,76 @@
-#ifndef QUEUE_H
-#define QUEUE_H
+#ifndef SCHED_H
+#define SCHED_H
 
 #include "common.h"
 
-#ifndef MLQ_SCHED
-#define MLQ_SCHED
-#endif
-
 #define MAX_PRIO 140
 
+/* Run queue layouts, see sched_set_rq_mode() */
+#define SCHED_RQ_GLOBAL	0	/* One MLQ shared by every CPU */
+#define SCHED_RQ_PERCPU	1	/* One MLQ per CPU, idle CPUs steal work */
+
 int queue_empty(void);
 
+/* Select the run queue layout, call before init_scheduler() */
+void sched_set_rq_mode(int mode, int num_cpus);
+
+/* Promote an MLQ process one level after it waited [dispatches]
+ * dispatches of its run queue, 0 disables aging */
+void sched_set_aging(int dispatches);
+
+/* Serve each MLQ level for at most slot[prio] dispatches per round when
+ * [on] is 1, strict priority (the default) when 0 */
+void sched_set_quota(int on);
+
+/* Select the scheduling policy by name ("mlq", "fifo", "sjf", "srtf", "cfs",
+ * "edf", "stride", "lottery"), call before init_scheduler().
+ * Return 0 on success, -1 if unknown */
+int sched_set_policy(const char * name);
+
+/* Name of the active scheduling policy */
+const char * sched_policy_name(void);
+
 void init_scheduler(void);
+
+/* Print scheduler statistics at the end of the simulation */
 void finish_scheduler(void);
 
+/* Dispatches served from MLQ level [prio] since init_scheduler() */
+unsigned long sched_dispatch_count(int prio);
+
+/* Longest wait, in dispatches, of a process of MLQ level [prio] */
+unsigned long sched_max_wait(int prio);
+
 /* Get the next process from ready queue */
 struct pcb_t * get_proc(void);
 
 /* Put a process back to run queue */
 void put_proc(struct pcb_t * proc);
 
+/* Get the next process for CPU [cpu] */
+struct pcb_t * get_cpu_proc(int cpu);
+
+/* Put a process preempted on CPU [cpu] back to run queue */
+void put_cpu_proc(int cpu, struct pcb_t * proc);
+
 /* Add a new process to ready queue */
 void add_proc(struct pcb_t * proc);
 
+/* [proc] executed one instruction on CPU [cpu] with [time_left] slots left
+ * in its quantum. Return 1 if it must be put back to run queue now */
+int sched_tick(int cpu, struct pcb_t * proc, int time_left);
+
+/* Account the turnaround and waiting time of [proc], which finished at
+ * time slot [now]. Call before freeing it */
+void sched_exit(struct pcb_t * proc, uint64_t now);
+
+/* Take every ready process accepted by [match] out of the ready queues,
+ * ownership passes to [match]. Return the number of processes removed */
+int kill_procs(int (*match)(struct pcb_t *, void *), void * arg);
+
+/* Call [hook] with the number of processes each kill_procs() removed */
+void sched_set_kill_hook(void (*hook)(int killed));
+
 #endif
 
 
@@ -0,0 +1,40 @@
+#ifndef SCHED_POLICY_H
+#define SCHED_POLICY_H
+
+#include "common.h"
+
+/*
+ * A scheduling policy. The front end in sched.c keeps the pcb bookkeeping
+ * and forwards every call to the active policy, which does its own locking.
+ */
+struct sched_policy {
+	const char * name;
+	/* Reset the ready set, called by init_scheduler() */
+	void (*init)(void);
+	/* A newly loaded process becomes ready */
+	void (*enqueue)(struct pcb_t * proc);
+	/* Next process for CPU [cpu], NULL if nothing is ready */
+	struct pcb_t * (*pick_next)(int cpu);
+	/* A process preempted on CPU [cpu] becomes ready again */
+	void (*requeue)(int cpu, struct pcb_t * proc);
+	/* [proc] executed one instruction on [cpu] and has [time_left] slots
+	 * left in its quantum. Return 1 to preempt it */
+	int (*tick)(int cpu, struct pcb_t * proc, int time_left);
+	/* See kill_procs() */
+	int (*kill)(int (*match)(struct pcb_t *, void *), void * arg);
+	/* See queue_empty() */
+	int (*empty)(void);
+	/* Print policy specific statistics, may be NULL */
+	void (*report)(void);
+};
+
+extern const struct sched_policy fifo_policy;
+extern const struct sched_policy sjf_policy;
+extern const struct sched_policy srtf_policy;
+extern const struct sched_policy cfs_policy;
+extern const struct sched_policy edf_policy;
+extern const struct sched_policy stride_policy;
+extern const struct sched_policy lottery_policy;
+
+#endif
+
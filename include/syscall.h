@@ -34,7 +34,7 @@ struct sc_regs {
 //typedef long (*sys_call_ptr_t)(const struct sc_regs *);
 extern const char* sys_call_table[];
 extern const int syscall_table_size;
-int syscall(struct pcb_t*, uint32_t, struct sc_regs*);
+int do_syscall(struct pcb_t*, uint32_t, struct sc_regs*);
 int libsyscall(struct pcb_t*, uint32_t, uint32_t, uint32_t, uint32_t);
 int __sys_ni_syscall(struct pcb_t*, struct sc_regs*);
 
@@ -3,14 +3,11 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include "twheel.h"
 
+/* A participant of the time slot barrier, see next_slot() */
 struct timer_id_t {
-	int done;
-	int fsh;
-	pthread_cond_t event_cond;
-	pthread_mutex_t event_lock;
-	pthread_cond_t timer_cond;
-	pthread_mutex_t timer_lock;
+	int sense;	/* Phase this participant waits to see flipped */
 };
 
 void start_timer();
@@ -23,6 +20,33 @@ void detach_event(struct timer_id_t * event);
 
 void next_slot(struct timer_id_t* timer_id);
 
+/* Like next_slot(), for a participant with nothing to do before slot
+ * [wake] (UINT64_MAX if only other participants can give it work). In
+ * tickless mode a slot where everybody is idle skips ahead to the
+ * earliest wake */
+void next_idle_slot(struct timer_id_t* timer_id, uint64_t wake);
+
+/* Step the time forward to slot [t] without the barrier, for callers
+ * that drive every participant themselves */
+void advance_time(uint64_t t);
+
+/* Call [fn] at the start of slot [expires], before any participant runs
+ * that slot. Arming and cancelling are O(1) */
+void timer_arm(struct tw_timer * t, uint64_t expires,
+	void (*fn)(struct tw_timer *));
+
+/* Disarm [t], return 0 if it was not armed */
+int timer_cancel(struct tw_timer * t);
+
+/* A slot no later than the next timer to fire, UINT64_MAX if none */
+uint64_t timer_next(void);
+
+/* Number of armed timers */
+int timer_pending(void);
+
+/* Turn tickless mode on or off, before start_timer() */
+void set_tickless(int on);
+
 uint64_t current_time();
 
 #endif
@@ -0,0 +1,53 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include "common.h"
+
+/*
+ * Per-CPU software TLB in front of pg_getpage(). Each CPU caches the
+ * (pid, pgn) -> fpn translations of the process it runs in a small
+ * set-associative table. A CPU selects its TLB with tlb_switch() before
+ * running a slot, the memory code then works on the TLB of the CPU it
+ * runs on. The TLB is flushed when the CPU switches to another process or
+ * to one that ran elsewhere since, and entries are dropped when their PTE
+ * changes or their page is picked as a victim.
+ */
+#define TLB_SETS 16
+#define TLB_WAYS 4
+
+struct tlb_entry {
+  uint32_t pid;
+  int pgn;
+  int fpn;
+  uint32_t *pte; /* PTE the translation was read from */
+  int valid;
+};
+
+struct tlb {
+  uint32_t pid; /* Process the entries belong to, 0 if none */
+  struct tlb_entry set[TLB_SETS][TLB_WAYS];
+  int next[TLB_SETS]; /* Way to replace next, round robin */
+  unsigned long hits, misses, flushes;
+};
+
+/* Allocate one empty TLB per CPU */
+void tlb_init(int nr_cpus);
+void tlb_free(void);
+
+/* Make [cpu]'s TLB the one used by this thread, for running [proc] */
+void tlb_switch(int cpu, struct pcb_t *proc);
+
+/* Look (pid, pgn) up in the current TLB. Return 0 and set *fpn on a hit */
+int tlb_lookup(uint32_t pid, int pgn, int *fpn);
+
+/* Cache the translation (pid, pgn) -> fpn read from [pte] */
+void tlb_insert(uint32_t pid, int pgn, int fpn, uint32_t *pte);
+
+/* Drop the translation of (pid, pgn), or the ones read from [pte] */
+void tlb_invalidate(uint32_t pid, int pgn);
+void tlb_invalidate_pte(uint32_t *pte);
+
+/* Sum the counters of every CPU's TLB */
+void tlb_stats(unsigned long *hits, unsigned long *misses, unsigned long *flushes);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TWHEEL_H
+#define TWHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Hierarchical timing wheel: TW_LEVELS wheels of TW_SIZE slots, a slot of
+ * level k spanning TW_SIZE^k ticks. A timer is filed by how far away it
+ * is and moved down a level each time its coarse slot comes up, so arming
+ * and cancelling are O(1) and a tick only touches one slot. Embed a
+ * struct tw_timer in the element and get it back with tw_entry(). */
+#define TW_BITS		6
+#define TW_SIZE		(1 << TW_BITS)
+#define TW_MASK		(TW_SIZE - 1)
+#define TW_LEVELS	4
+#define TW_SPAN		(1ULL << (TW_BITS * TW_LEVELS))	/* Farthest filing */
+
+struct tw_timer {
+        struct tw_timer * next;
+        struct tw_timer ** pprev;	/* NULL while not armed */
+        uint64_t expires;		/* Tick to fire in */
+        void (*fn)(struct tw_timer *);	/* Called once, from tw_advance() */
+        int level, slot;
+};
+
+struct twheel {
+        uint64_t now;
+        uint64_t occupied[TW_LEVELS];	/* Bit i set if slot i is not empty */
+        struct tw_timer * slots[TW_LEVELS][TW_SIZE];
+        int pending;			/* Armed timers */
+};
+
+#define tw_entry(ptr, type, member) \
+        ((type *)((char *)(ptr) - offsetof(type, member)))
+
+/* Start an empty wheel at tick [now] */
+void tw_init(struct twheel * w, uint64_t now);
+
+/* Fire [fn] on tick [expires], at the next tick if that already passed */
+void tw_arm(struct twheel * w, struct tw_timer * t, uint64_t expires,
+            void (*fn)(struct tw_timer *));
+
+/* Disarm [t], return 0 if it was not armed */
+int tw_cancel(struct twheel * w, struct tw_timer * t);
+
+static inline int tw_armed(const struct tw_timer * t) {
+        return t->pprev != NULL;
+}
+
+/* Move the wheel to tick [now], firing every timer due on the way */
+void tw_advance(struct twheel * w, uint64_t now);
+
+/* A tick no later than the next expiry, UINT64_MAX if nothing is armed */
+uint64_t tw_next(const struct twheel * w);
+
+#endif
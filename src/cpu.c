@@ -4,6 +4,9 @@
 #include "mm.h"
 #include "syscall.h"
 #include "libmem.h"
+#include "perf.h"
+#include <pthread.h>
+#include <stdlib.h>
 
 int calc(struct pcb_t *proc)
 {
@@ -58,55 +61,223 @@ int write(
 	return write_mem(proc->regs[destination] + offset, proc, data);
 }
 
-int run(struct pcb_t *proc)
+/* Block instructions without paging go a byte at a time */
+int read_blk(struct pcb_t *proc, uint32_t source, uint32_t offset, uint32_t size)
 {
-	/* Check if Program Counter point to the proper instruction */
-	if (proc->pc >= proc->code->size)
+	BYTE data;
+	uint32_t i;
+	for (i = 0; i < size; i++)
+		if (read_mem(proc->regs[source] + offset + i, proc, &data))
+			return 1;
+	return 0;
+}
+
+int write_blk(struct pcb_t *proc, BYTE data, uint32_t destination,
+	uint32_t offset, uint32_t size, int count)
+{
+	uint32_t i;
+	for (i = 0; i < size; i++)
+		if (write_mem(proc->regs[destination] + offset + i, proc,
+			count ? (BYTE)(data + i) : data))
+			return 1;
+	return 0;
+}
+
+int copy_blk(struct pcb_t *proc, uint32_t source, uint32_t destination,
+	uint32_t offset, uint32_t size)
+{
+	BYTE data;
+	uint32_t i;
+	for (i = 0; i < size; i++)
+		if (read_mem(proc->regs[source] + offset + i, proc, &data) ||
+			write_mem(proc->regs[destination] + offset + i, proc, data))
+			return 1;
+	return 0;
+}
+
+/*
+ * exec() runs the pre-decoded ops of a process. With GCC or clang that is
+ * threaded code: every op carries the address of its handler label and
+ * each handler jumps straight to the next one. Other compilers (or
+ * -DCPU_SWITCH_DISPATCH) loop over a switch on the opcode instead. The
+ * handlers are written once and the macros below give them either shape.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(CPU_SWITCH_DISPATCH)
+#define CPU_THREADED_DISPATCH
+#endif
+
+#ifdef CPU_THREADED_DISPATCH
+#define DISPATCH()	op = &ops[proc->pc++]; goto *op->handler;
+#define OP(name)	op_##name: perf_insn(proc, name);
+#define OP_INVALID	op_invalid:
+#define NEXT()		if (--budget == 0 || proc->pc >= end || proc->sleeping) \
+				return stat; \
+			DISPATCH()
+
+/* Handler labels of exec() by opcode, fetched once by the first
+ * predecode(), which loader pool threads may run concurrently */
+static const void * const * handlers;
+static pthread_once_t handlers_once = PTHREAD_ONCE_INIT;
+#else
+#define DISPATCH()	for (;;) switch ((op = &ops[proc->pc++])->opcode)
+#define OP(name)	case name: perf_insn(proc, name);
+#define OP_INVALID	default:
+#define NEXT()		if (--budget == 0 || proc->pc >= end || proc->sleeping) \
+				return stat; \
+			continue;
+#endif
+
+/*
+ * Execute up to [budget] instructions of [proc], stopping early at the end
+ * of its code or once it went to sleep
+ * @return: status of the last instruction
+ */
+static int exec(struct pcb_t *proc, uint32_t budget)
+{
+#ifdef CPU_THREADED_DISPATCH
+	static const void * const labels[NR_OPCODES + 1] = {
+		[CALC] = &&op_CALC,
+		[ALLOC] = &&op_ALLOC,
+		[FREE] = &&op_FREE,
+		[READ] = &&op_READ,
+		[WRITE] = &&op_WRITE,
+		[SYSCALL] = &&op_SYSCALL,
+		[MEMSET] = &&op_MEMSET,
+		[MEMCPY] = &&op_MEMCPY,
+		[READBLK] = &&op_READBLK,
+		[WRITEBLK] = &&op_WRITEBLK,
+		[NR_OPCODES] = &&op_invalid,
+	};
+	if (proc == NULL)
 	{
-		return 1;
+		handlers = labels;
+		return 0;
 	}
-
-	struct inst_t ins = proc->code->text[proc->pc];
-	proc->pc++;
+#endif
+	const struct op_t *ops = proc->code->ops;
+	const struct op_t *op;
+	uint32_t end = proc->code->size;
 	int stat = 1;
-switch (ins.opcode)
+
+	DISPATCH()
 	{
-	case CALC:
+	OP(CALC)
 		stat = calc(proc);
-		break;
-	case ALLOC:
+		NEXT()
+	OP(ALLOC)
 #ifdef MM_PAGING
-		stat = liballoc(proc, ins.arg_0, ins.arg_1);
+		stat = liballoc(proc, op->arg_0, op->arg_1);
 #else
-		stat = alloc(proc, ins.arg_0, ins.arg_1);
+		stat = alloc(proc, op->arg_0, op->arg_1);
 #endif
-		break;
-	case FREE:
+		NEXT()
+	OP(FREE)
+#ifdef MM_PAGING
+		stat = libfree(proc, op->arg_0);
+#else
+		stat = free_data(proc, op->arg_0);
+#endif
+		NEXT()
+	OP(READ)
+	{
+#ifdef MM_PAGING
+		/* The value read is not kept, as before the ops */
+		uint32_t data = op->arg_2;
+		stat = libread(proc, op->arg_0, op->arg_1, &data);
+#else
+		stat = read(proc, op->arg_0, op->arg_1, op->arg_2);
+#endif
+	}
+		NEXT()
+	OP(WRITE)
 #ifdef MM_PAGING
-		stat = libfree(proc, ins.arg_0);
+		stat = libwrite(proc, op->arg_0, op->arg_1, op->arg_2);
 #else
-		stat = free_data(proc, ins.arg_0);
+		stat = write(proc, op->arg_0, op->arg_1, op->arg_2);
 #endif
-		break;
-	case READ:
+		NEXT()
+	OP(SYSCALL)
+		stat = libsyscall(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3);
+		NEXT()
+	OP(MEMSET)
 #ifdef MM_PAGING
-		stat = libread(proc, ins.arg_0, ins.arg_1, &ins.arg_2);
+		stat = libmemset(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3);
 #else
-		stat = read(proc, ins.arg_0, ins.arg_1, ins.arg_2);
+		stat = write_blk(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3, 0);
 #endif
-		break;
-	case WRITE:
+		NEXT()
+	OP(MEMCPY)
 #ifdef MM_PAGING
-		stat = libwrite(proc, ins.arg_0, ins.arg_1, ins.arg_2);
+		stat = libmemcpy(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3);
 #else
-		stat = write(proc, ins.arg_0, ins.arg_1, ins.arg_2);
+		stat = copy_blk(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3);
 #endif
-		break;
-	case SYSCALL:
-		stat = libsyscall(proc, ins.arg_0, ins.arg_1, ins.arg_2, ins.arg_3);
-		break;
-	default:
+		NEXT()
+	OP(READBLK)
+#ifdef MM_PAGING
+		stat = libreadblk(proc, op->arg_0, op->arg_1, op->arg_2);
+#else
+		stat = read_blk(proc, op->arg_0, op->arg_1, op->arg_2);
+#endif
+		NEXT()
+	OP(WRITEBLK)
+#ifdef MM_PAGING
+		stat = libwriteblk(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3);
+#else
+		stat = write_blk(proc, op->arg_0, op->arg_1, op->arg_2, op->arg_3, 1);
+#endif
+		NEXT()
+	OP_INVALID
 		stat = 1;
+		NEXT()
+	}
+}
+
+#ifdef CPU_THREADED_DISPATCH
+static void fetch_handlers(void)
+{
+	exec(NULL, 0);
+}
+#endif
+
+void predecode(struct code_seg_t *code)
+{
+	struct op_t *ops = malloc(sizeof(struct op_t) * (code->size ? code->size : 1));
+	uint32_t i;
+
+#ifdef CPU_THREADED_DISPATCH
+	pthread_once(&handlers_once, fetch_handlers);
+#endif
+	for (i = 0; i < code->size; i++)
+	{
+		const struct inst_t *ins = &code->text[i];
+		ops[i].opcode = ins->opcode;
+		ops[i].arg_0 = ins->arg_0;
+		ops[i].arg_1 = ins->arg_1;
+		ops[i].arg_2 = ins->arg_2;
+		ops[i].arg_3 = ins->arg_3;
+#ifdef CPU_THREADED_DISPATCH
+		ops[i].handler = handlers[(unsigned)ins->opcode < NR_OPCODES ?
+			ins->opcode : NR_OPCODES];
+#else
+		ops[i].handler = NULL;
+#endif
+	}
+	code->ops = ops;
+}
+
+int run_slice(struct pcb_t *proc, uint32_t budget)
+{
+	/* Check if Program Counter point to the proper instruction */
+	if (proc->pc >= proc->code->size)
+	{
+		return 1;
 	}
-	return stat;
+
+	return exec(proc, budget ? budget : 1);
+}
+
+int run(struct pcb_t *proc)
+{
+	return run_slice(proc, 1);
 }
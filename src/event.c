@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "event.h"
+
+/*
+! Order two events
+* @return: 1 if a must fire before b
+*/
+static int event_before(const struct event * a, const struct event * b) {
+        if (a->time != b->time)
+                return a->time < b->time;
+        if (a->kind != b->kind)
+                return a->kind < b->kind;
+        return a->id < b->id;
+}
+
+/*
+! Schedule an event
+* @param q: queue to add the event to
+* @param ev: event to add
+*/
+void event_push(struct event_queue_t * q, struct event ev) {
+        // * Make room when the heap is full
+        if (q->size == q->capacity) {
+                int capacity = q->capacity ? q->capacity * 2 : 16;
+                struct event * heap = realloc(q->heap, capacity * sizeof(struct event));
+                if (heap == NULL) {
+                        printf("event: out of memory growing to %d events\n", capacity);
+                        exit(1);
+                }
+                q->heap = heap;
+                q->capacity = capacity;
+        }
+
+        // * Sift the new event up from the last leaf
+        int i = q->size++;
+        while (i > 0) {
+                int parent = (i - 1) / 2;
+                if (!event_before(&ev, &q->heap[parent]))
+                        break;
+                q->heap[i] = q->heap[parent];
+                i = parent;
+        }
+        q->heap[i] = ev;
+}
+
+/*
+! Take the earliest event
+* @param q: queue to take the event from
+* @param ev: where to store the event
+* @return: 1 if an event was taken, 0 if the queue is empty
+*/
+int event_pop(struct event_queue_t * q, struct event * ev) {
+        if (q->size == 0)
+                return 0;
+
+        *ev = q->heap[0];
+
+        // * Sift the last leaf down from the root
+        struct event last = q->heap[--q->size];
+        int i = 0;
+        for (;;) {
+                int child = 2 * i + 1;
+                if (child >= q->size)
+                        break;
+                if (child + 1 < q->size && event_before(&q->heap[child + 1], &q->heap[child]))
+                        child++;
+                if (!event_before(&q->heap[child], &last))
+                        break;
+                q->heap[i] = q->heap[child];
+                i = child;
+        }
+        q->heap[i] = last;
+
+        return 1;
+}
+
+void free_event_queue(struct event_queue_t * q) {
+        free(q->heap);
+        q->heap = NULL;
+        q->size = 0;
+        q->capacity = 0;
+}
@@ -0,0 +1,190 @@
+#include "image.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Images hold struct inst_t as is */
+_Static_assert(sizeof(struct inst_t) == 5 * sizeof(uint32_t),
+	"struct inst_t is not packed");
+_Static_assert(sizeof(struct image_header) % sizeof(uint32_t) == 0,
+	"instructions of an image are not aligned");
+
+#define OPT_CALC	"calc"
+#define OPT_ALLOC	"alloc"
+#define OPT_FREE	"free"
+#define OPT_READ	"read"
+#define OPT_WRITE	"write"
+#define OPT_SYSCALL	"syscall"
+#define OPT_MEMSET	"memset"
+#define OPT_MEMCPY	"memcpy"
+#define OPT_READBLK	"readblk"
+#define OPT_WRITEBLK	"writeblk"
+
+static enum ins_opcode_t get_opcode(char * opt) {
+	if (!strcmp(opt, OPT_CALC)) {
+		return CALC;
+	}else if (!strcmp(opt, OPT_ALLOC)) {
+		return ALLOC;
+	}else if (!strcmp(opt, OPT_FREE)) {
+		return FREE;
+	}else if (!strcmp(opt, OPT_READ)) {
+		return READ;
+	}else if (!strcmp(opt, OPT_WRITE)) {
+		return WRITE;
+	}else if (!strcmp(opt, OPT_SYSCALL)) {
+		return SYSCALL;
+	}else if (!strcmp(opt, OPT_MEMSET)) {
+		return MEMSET;
+	}else if (!strcmp(opt, OPT_MEMCPY)) {
+		return MEMCPY;
+	}else if (!strcmp(opt, OPT_READBLK)) {
+		return READBLK;
+	}else if (!strcmp(opt, OPT_WRITEBLK)) {
+		return WRITEBLK;
+	}else{
+		printf("get_opcode return Opcode: %s\n", opt);
+		exit(1);
+	}
+}
+
+void read_program(FILE * file, const char * path, uint32_t * priority,
+		struct code_seg_t * code) {
+	char opcode[10];
+	if (fscanf(file, "%u %u", priority, &code->size) != 2) {
+		printf("Invalid process description at '%s'\n", path);
+		exit(1);
+	}
+	code->text = (struct inst_t*)calloc(
+		code->size ? code->size : 1, sizeof(struct inst_t)
+	);
+	code->ops = NULL;
+	uint32_t i = 0;
+	char buf[200];
+	for (i = 0; i < code->size; i++) {
+		if (fscanf(file, "%9s", opcode) != 1) {
+			printf("Process description at '%s' has fewer than %u instructions\n",
+				path, code->size);
+			exit(1);
+		}
+		code->text[i].opcode = get_opcode(opcode);
+		switch(code->text[i].opcode) {
+		case CALC:
+			break;
+		case ALLOC:
+			fscanf(
+				file,
+				"%u %u\n",
+				&code->text[i].arg_0,
+				&code->text[i].arg_1
+			);
+			break;
+		case FREE:
+			fscanf(file, "%u\n", &code->text[i].arg_0);
+			break;
+		case READ:
+		case WRITE:
+		case READBLK:
+			/* readblk [source] [offset] [size] */
+			fscanf(
+				file,
+				"%u %u %u\n",
+				&code->text[i].arg_0,
+				&code->text[i].arg_1,
+				&code->text[i].arg_2
+			);
+			break;
+		case MEMSET:
+		case MEMCPY:
+		case WRITEBLK:
+			/* memset [value] [destination] [offset] [size]
+			 * memcpy [source] [destination] [offset] [size]
+			 * writeblk [value] [destination] [offset] [size] */
+			fscanf(
+				file,
+				"%u %u %u %u\n",
+				&code->text[i].arg_0,
+				&code->text[i].arg_1,
+				&code->text[i].arg_2,
+				&code->text[i].arg_3
+			);
+			break;
+		case SYSCALL:
+			fgets(buf, sizeof(buf), file);
+			sscanf(buf, "%u%u%u%u",
+			           &code->text[i].arg_0,
+			           &code->text[i].arg_1,
+			           &code->text[i].arg_2,
+			           &code->text[i].arg_3
+			);
+			break;
+		default:
+			printf("Opcode: %s\n", opcode);
+			exit(1);
+		}
+	}
+}
+
+int map_image(const char * path, uint32_t * priority, struct code_seg_t * code) {
+	struct image_header hdr;
+	struct stat st;
+	int fd;
+	if ((fd = open(path, O_RDONLY)) < 0) {
+		printf("Cannot find process description at '%s'\n", path);
+		exit(1);
+	}
+	/* Anything not starting with the magic is left to the text parser */
+	if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+			hdr.magic != IMAGE_MAGIC) {
+		close(fd);
+		return 1;
+	}
+	if (hdr.version != IMAGE_VERSION) {
+		printf("Image '%s' has version %u, expected %u, rebuild it with pasm\n",
+			path, hdr.version, IMAGE_VERSION);
+		exit(1);
+	}
+	if (fstat(fd, &st) != 0 || (uint64_t)st.st_size !=
+			sizeof(hdr) + (uint64_t)hdr.size * sizeof(struct inst_t)) {
+		printf("Image '%s' is truncated or corrupt\n", path);
+		exit(1);
+	}
+	/* The mapping outlives the descriptor, unmap_image() releases it */
+	void * map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		printf("Cannot map image '%s'\n", path);
+		exit(1);
+	}
+	*priority = hdr.priority;
+	code->size = hdr.size;
+	code->text = (struct inst_t*)((char*)map + sizeof(hdr));
+	code->ops = NULL;
+	return 0;
+}
+
+void unmap_image(const struct code_seg_t * code) {
+	munmap((char*)code->text - sizeof(struct image_header),
+		sizeof(struct image_header) + code->size * sizeof(struct inst_t));
+}
+
+int write_image(const char * path, uint32_t priority,
+		const struct code_seg_t * code) {
+	struct image_header hdr = {
+		IMAGE_MAGIC, IMAGE_VERSION, priority, code->size
+	};
+	FILE * file;
+	if ((file = fopen(path, "wb")) == NULL)
+		return -1;
+	if (fwrite(&hdr, sizeof(hdr), 1, file) != 1 ||
+			fwrite(code->text, sizeof(struct inst_t), code->size, file)
+			!= code->size) {
+		fclose(file);
+		return -1;
+	}
+	return fclose(file);
+}
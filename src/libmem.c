@@ -30,6 +30,8 @@
 #include "mm.h"
 #include "syscall.h"
 #include "libmem.h"
+#include "tlb.h"
+#include "perf.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <pthread.h>
@@ -255,26 +257,59 @@ int libfree(struct pcb_t *proc, uint32_t reg_index)
  */
 int pg_getpage(struct mm_struct *mm, int pgn, int *fpn, struct pcb_t *caller)
 {
+  // * Translations cached by this CPU skip the page table
+  if (tlb_lookup(caller->pid, pgn, fpn) == 0)
+  {
+    perf_count(caller, PERF_TLB_HIT);
+    return 0;
+  }
+  perf_count(caller, PERF_TLB_MISS);
+
   uint32_t pte = mm->pgd[pgn];
 
-  if (!PAGING_PAGE_PRESENT(pte))
+  // * A swapped page is present in the page table but not in MEMRAM
+  if (!PAGING_PAGE_PRESENT(pte) || (pte & PAGING_PTE_SWAPPED_MASK))
   { 
     int new_fpn;
+
+    perf_count(caller, PERF_PGFAULT);
+    if (pte & PAGING_PTE_SWAPPED_MASK)
+      perf_count(caller, PERF_SWAPIN);
         
     // * Get a free frame page number (FPN) from the memory physical
     if (MEMPHY_get_freefp(caller->mram, &new_fpn) != 0)
     {
-        // * Find a victim page to swap out
-        int victim_pgn;
-        if (find_victim_page(mm, &victim_pgn) != 0)
+        // * Find a victim page to swap out, skipping pages that are no
+        // * longer in MEMRAM
+        int victim_pgn, swpfpn;
+        uint32_t vicpte;
+        do {
+          if (find_victim_page(mm, &victim_pgn) != 0)
+          {
+              return -1;  // Không tìm thấy trang nạn nhân
+          }
+          vicpte = mm->pgd[victim_pgn];
+        } while (!PAGING_PAGE_PRESENT(vicpte) || (vicpte & PAGING_PTE_SWAPPED_MASK));
+
+        if (MEMPHY_get_freefp(caller->active_mswp, &swpfpn) != 0)
         {
-            return -1;  // Không tìm thấy trang nạn nhân
+            enlist_pgn_node(&mm->fifo_pgn, victim_pgn);
+            return -1;  // MEMSWAP đầy
         }
-        // * Swap out the victim page
-        new_fpn = PAGING_FPN(mm->pgd[victim_pgn]);
+        // * Swap out the victim page, its frame goes to the faulting one
+        new_fpn = PAGING_FPN(vicpte);
+        __swap_cp_page(caller->mram, new_fpn, caller->active_mswp, swpfpn);
+        tlb_invalidate(caller->pid, victim_pgn);
+        pte_set_swap(&mm->pgd[victim_pgn], 0, swpfpn);
+        perf_count(caller, PERF_SWAPOUT);
     }
-    
+
     // * Swap the page from MEMSWAP to MEMRAM
+    if (pte & PAGING_PTE_SWAPPED_MASK)
+    {
+        __swap_cp_page(caller->active_mswp, PAGING_PTE_SWP(pte), caller->mram, new_fpn);
+        MEMPHY_put_freefp(caller->active_mswp, PAGING_PTE_SWP(pte));
+    }
     pte_set_fpn(&mm->pgd[pgn], new_fpn);
 
     // * Update the page table entry
@@ -282,6 +317,7 @@ int pg_getpage(struct mm_struct *mm, int pgn, int *fpn, struct pcb_t *caller)
   }
 
   *fpn = PAGING_FPN(mm->pgd[pgn]);
+  tlb_insert(caller->pid, pgn, *fpn, &mm->pgd[pgn]);
 
   return 0;
 }
@@ -432,10 +468,269 @@ int libwrite(
   return val;
 }
 
+/*
+ *pg_getblk - read a run of bytes at given address
+ *@mm: memory region
+ *@addr: virtual address of the first byte
+ *@buf: obtained bytes
+ *@len: number of bytes
+ *
+ * Every page is translated once and its bytes moved in one go
+ */
+int pg_getblk(struct mm_struct *mm, int addr, BYTE *buf, int len, struct pcb_t *caller)
+{
+  while (len > 0)
+  {
+    int off = PAGING_OFFST(addr);
+    int n = PAGING_PAGESZ - off < len ? PAGING_PAGESZ - off : len;
+    int fpn;
+
+    // * Get the page to MEMRAM, swap from MEMSWAP if needed
+    if (pg_getpage(mm, PAGING_PGN(addr), &fpn, caller) != 0)
+      return -1; /* invalid page access */
+    if (MEMPHY_read_blk(caller->mram, fpn * PAGING_PAGESZ + off, buf, n) != 0)
+      return -1;
+
+    addr += n;
+    buf += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+/*
+ *pg_setblk - write a run of bytes at given address
+ *@mm: memory region
+ *@addr: virtual address of the first byte
+ *@buf: written bytes, NULL to write @fill to every byte
+ *@fill: byte written when @buf is NULL
+ *@len: number of bytes
+ */
+int pg_setblk(struct mm_struct *mm, int addr, const BYTE *buf, BYTE fill, int len,
+              struct pcb_t *caller)
+{
+  while (len > 0)
+  {
+    int off = PAGING_OFFST(addr);
+    int n = PAGING_PAGESZ - off < len ? PAGING_PAGESZ - off : len;
+    int fpn;
+
+    // * Get the page to MEMRAM, swap from MEMSWAP if needed
+    if (pg_getpage(mm, PAGING_PGN(addr), &fpn, caller) != 0)
+      return -1; /* invalid page access */
+    if (MEMPHY_write_blk(caller->mram, fpn * PAGING_PAGESZ + off, buf, fill, n) != 0)
+      return -1;
+
+    addr += n;
+    if (buf != NULL)
+      buf += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+/*
+ *get_blk_addr - locate a block in region memory
+ *@caller: caller
+ *@vmaid: ID vm area of the region
+ *@rgid: memory region ID (used to identify variable in symbole table)
+ *@offset: offset of the block in the region
+ *@size: size of the block, which must lie within the region
+ *@addr: return virtual address of the block
+ */
+static int get_blk_addr(struct pcb_t *caller, int vmaid, int rgid, int offset, int size, int *addr)
+{
+  struct vm_rg_struct *currg = get_symrg_byid(caller->mm, rgid);
+  struct vm_area_struct *cur_vma = get_vma_by_num(caller->mm, vmaid);
+
+  if (currg == NULL || cur_vma == NULL) /* Invalid memory identify */
+    return -1;
+  if (offset < 0 || size < 0 || offset + size > currg->rg_end - currg->rg_start)
+    return -1;
+
+  *addr = currg->rg_start + offset;
+  return 0;
+}
+
+/*
+ *__readblk - read a block of region memory
+ *@caller: caller
+ *@vmaid: ID vm area of the region
+ *@rgid: memory region ID (used to identify variable in symbole table)
+ *@offset: offset of the block in the region
+ *@size: size of the block
+ */
+int __readblk(struct pcb_t *caller, int vmaid, int rgid, int offset, int size)
+{
+  BYTE buf[PAGING_PAGESZ];
+  int addr, n;
+
+  if (get_blk_addr(caller, vmaid, rgid, offset, size, &addr) != 0)
+    return -1;
+
+  // * The bytes read are not kept, as for READ
+  for (; size > 0; addr += n, size -= n)
+  {
+    n = size < PAGING_PAGESZ ? size : PAGING_PAGESZ;
+    if (pg_getblk(caller->mm, addr, buf, n, caller) != 0)
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ *__writeblk - write a block of region memory
+ *@caller: caller
+ *@vmaid: ID vm area of the region
+ *@rgid: memory region ID (used to identify variable in symbole table)
+ *@offset: offset of the block in the region
+ *@size: size of the block
+ *@value: first byte written, the next ones count up from it
+ */
+int __writeblk(struct pcb_t *caller, int vmaid, int rgid, int offset, int size, BYTE value)
+{
+  BYTE buf[PAGING_PAGESZ];
+  int addr, n, i;
+
+  if (get_blk_addr(caller, vmaid, rgid, offset, size, &addr) != 0)
+    return -1;
+
+  for (; size > 0; addr += n, size -= n)
+  {
+    n = size < PAGING_PAGESZ ? size : PAGING_PAGESZ;
+    for (i = 0; i < n; i++)
+      buf[i] = value++;
+    if (pg_setblk(caller->mm, addr, buf, 0, n, caller) != 0)
+      return -1;
+  }
+
+  return 0;
+}
+
+/*
+ *__memset - fill a block of region memory
+ *@caller: caller
+ *@vmaid: ID vm area of the region
+ *@rgid: memory region ID (used to identify variable in symbole table)
+ *@offset: offset of the block in the region
+ *@size: size of the block
+ *@value: byte written
+ */
+int __memset(struct pcb_t *caller, int vmaid, int rgid, int offset, int size, BYTE value)
+{
+  int addr;
+
+  if (get_blk_addr(caller, vmaid, rgid, offset, size, &addr) != 0)
+    return -1;
+
+  return pg_setblk(caller->mm, addr, NULL, value, size, caller);
+}
+
+/*
+ *__memcpy - copy a block between two regions memory
+ *@caller: caller
+ *@vmaid: ID vm area of the regions
+ *@srcid: source memory region ID
+ *@dstid: destination memory region ID
+ *@offset: offset of the block in both regions
+ *@size: size of the block
+ */
+int __memcpy(struct pcb_t *caller, int vmaid, int srcid, int dstid, int offset, int size)
+{
+  BYTE buf[PAGING_PAGESZ];
+  int src, dst, n;
+
+  if (get_blk_addr(caller, vmaid, srcid, offset, size, &src) != 0 ||
+      get_blk_addr(caller, vmaid, dstid, offset, size, &dst) != 0)
+    return -1;
+
+  // * A chunk is read before its destination page is brought in, which
+  // * may swap the source page out
+  for (; size > 0; src += n, dst += n, size -= n)
+  {
+    n = size < PAGING_PAGESZ ? size : PAGING_PAGESZ;
+    if (pg_getblk(caller->mm, src, buf, n, caller) != 0 ||
+        pg_setblk(caller->mm, dst, buf, 0, n, caller) != 0)
+      return -1;
+  }
+
+  return 0;
+}
+
+/* Dump the physical memory after a block instruction */
+static void blk_dump(struct pcb_t *proc, const char *what)
+{
+  pthread_mutex_lock(&log_msg);
+  printf("===== PHYSICAL MEMORY AFTER %s =====\n", what);
+#ifdef IODUMP
+#ifdef PAGETBL_DUMP
+  print_pgtbl(proc, 0, -1);
+#endif
+  MEMPHY_dump(proc->mram);
+#endif
+  printf("================================================================\n");
+  pthread_mutex_unlock(&log_msg);
+}
+
+/*libreadblk - PAGING-based read of a block of region memory */
+int libreadblk(
+    struct pcb_t *proc, // Process executing the instruction
+    uint32_t source,    // Index of source register
+    uint32_t offset,    // Block starts at [source] + [offset]
+    uint32_t size)
+{
+  int val = __readblk(proc, 0, source, offset, size);
+  blk_dump(proc, "BLOCK READING");
+  return val;
+}
+
+/*libwriteblk - PAGING-based write of a block of region memory */
+int libwriteblk(
+    struct pcb_t *proc,   // Process executing the instruction
+    BYTE data,            // First byte written, the next ones count up
+    uint32_t destination, // Index of destination register
+    uint32_t offset,      // Block starts at [destination] + [offset]
+    uint32_t size)
+{
+  int val = __writeblk(proc, 0, destination, offset, size, data);
+  blk_dump(proc, "BLOCK WRITING");
+  return val;
+}
+
+/*libmemset - PAGING-based fill of a block of region memory */
+int libmemset(
+    struct pcb_t *proc,   // Process executing the instruction
+    BYTE data,            // Byte written
+    uint32_t destination, // Index of destination register
+    uint32_t offset,      // Block starts at [destination] + [offset]
+    uint32_t size)
+{
+  int val = __memset(proc, 0, destination, offset, size, data);
+  blk_dump(proc, "MEMSET");
+  return val;
+}
+
+/*libmemcpy - PAGING-based copy of a block between regions memory */
+int libmemcpy(
+    struct pcb_t *proc,   // Process executing the instruction
+    uint32_t source,      // Index of source register
+    uint32_t destination, // Index of destination register
+    uint32_t offset,      // Block starts at [register] + [offset] in both
+    uint32_t size)
+{
+  int val = __memcpy(proc, 0, source, destination, offset, size);
+  blk_dump(proc, "MEMCPY");
+  return val;
+}
+
 /*free_pcb_memphy - collect all memphy of pcb
  *@caller: caller
- *@vmaid: ID vm area to alloc memory region
- *@incpgnum: number of page
+ *
+ *Give the frames of every page of a finished process back to MEMRAM, or
+ *to the active MEMSWAP for the pages swapped out
  */
 int free_pcb_memph(struct pcb_t *caller)
 {
@@ -448,12 +743,15 @@ int free_pcb_memph(struct pcb_t *caller)
     pte= caller->mm->pgd[pagenum];
 
     if (!PAGING_PAGE_PRESENT(pte))
+      continue;
+
+    if (pte & PAGING_PTE_SWAPPED_MASK)
     {
+      fpn = PAGING_PTE_SWP(pte);
+      MEMPHY_put_freefp(caller->active_mswp, fpn);
+    } else {
       fpn = PAGING_PTE_FPN(pte);
       MEMPHY_put_freefp(caller->mram, fpn);
-    } else {
-      fpn = PAGING_PTE_SWP(pte);
-      MEMPHY_put_freefp(caller->active_mswp, fpn);    
     }
   }
 
@@ -23,5 +23,5 @@ int libsyscall (struct pcb_t *caller,
    regs.a2 = a2;
    regs.a3 = a3;
 
-   return syscall(caller, syscall_idx, &regs);
+   return do_syscall(caller, syscall_idx, &regs);
 }
@@ -1,105 +1,135 @@
-
 #include "loader.h"
+#include "cpu.h"
+#include "perf.h"
+#include "image.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 static uint32_t avail_pid = 1;
 
-#define OPT_CALC	"calc"
-#define OPT_ALLOC	"alloc"
-#define OPT_FREE	"free"
-#define OPT_READ	"read"
-#define OPT_WRITE	"write"
-#define OPT_SYSCALL	"syscall"
+/*
+ * Code segments are cached by path: every process loaded from the same
+ * program shares one segment, read and decoded once and never written
+ * after. The loader adds references and the CPUs drop them as processes
+ * finish, the last one frees the segment.
+ */
+struct code_cache {
+	struct code_seg_t code;		/* First, release_code() gets back here */
+	uint32_t refs;
+	uint32_t priority;
+	int mapped;			/* text is an image mapping, not malloc'ed */
+	int ready;			/* Read and decoded, see get_code() */
+	struct code_cache * next;	/* Next segment in its bucket */
+	char path[100];
+};
+
+#define CODE_CACHE_BUCKETS	64
+
+static struct code_cache * code_cache[CODE_CACHE_BUCKETS];
+static pthread_mutex_t code_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t code_ready = PTHREAD_COND_INITIALIZER;
+
+static unsigned code_hash(const char * path) {
+	unsigned h = 5381;
+	while (*path)
+		h = h * 33 + (unsigned char)*path++;
+	return h % CODE_CACHE_BUCKETS;
+}
+
+/*
+ * Get the segment of [path] with a new reference, reading it if needed.
+ * Several loader threads may ask for the same program at once: the first
+ * one lists the segment before reading it, outside of the lock, and the
+ * others wait until it is ready.
+ */
+static struct code_cache * get_code(const char * path) {
+	struct code_cache ** bucket = &code_cache[code_hash(path)];
+	struct code_cache * c;
+	pthread_mutex_lock(&code_lock);
+	for (c = *bucket; c != NULL; c = c->next) {
+		if (!strcmp(c->path, path)) {
+			c->refs++;
+			while (!c->ready)
+				pthread_cond_wait(&code_ready, &code_lock);
+			pthread_mutex_unlock(&code_lock);
+			return c;
+		}
+	}
+	c = (struct code_cache*)calloc(1, sizeof(struct code_cache));
+	snprintf(c->path, sizeof(c->path), "%s", path);
+	c->refs = 1;
+	c->next = *bucket;
+	*bucket = c;
+	pthread_mutex_unlock(&code_lock);
+
+	c->mapped = map_image(path, &c->priority, &c->code) == 0;
+	if (!c->mapped) {
+		FILE * file;
+		if ((file = fopen(path, "r")) == NULL) {
+			printf("Cannot find process description at '%s'\n", path);
+			exit(1);
+		}
+		read_program(file, path, &c->priority, &c->code);
+		fclose(file);
+	}
+	predecode(&c->code);
+
+	pthread_mutex_lock(&code_lock);
+	c->ready = 1;
+	pthread_cond_broadcast(&code_ready);
+	pthread_mutex_unlock(&code_lock);
+	return c;
+}
 
-static enum ins_opcode_t get_opcode(char * opt) {
-	if (!strcmp(opt, OPT_CALC)) {
-		return CALC;
-	}else if (!strcmp(opt, OPT_ALLOC)) {
-		return ALLOC;
-	}else if (!strcmp(opt, OPT_FREE)) {
-		return FREE;
-	}else if (!strcmp(opt, OPT_READ)) {
-		return READ;
-	}else if (!strcmp(opt, OPT_WRITE)) {
-		return WRITE;
-	}else if (!strcmp(opt, OPT_SYSCALL)) {
-		return SYSCALL;
-	}else{
-		printf("get_opcode return Opcode: %s\n", opt);
-		exit(1);
+void release_code(const struct code_seg_t * code) {
+	struct code_cache * c = (struct code_cache*)code;
+	struct code_cache ** pp;
+	pthread_mutex_lock(&code_lock);
+	if (--c->refs > 0) {
+		pthread_mutex_unlock(&code_lock);
+		return;
 	}
+	for (pp = &code_cache[code_hash(c->path)]; *pp != c; pp = &(*pp)->next)
+		;
+	*pp = c->next;
+	pthread_mutex_unlock(&code_lock);
+
+	free(c->code.ops);
+	if (c->mapped)
+		unmap_image(&c->code);
+	else
+		free(c->code.text);
+	free(c);
 }
 
 struct pcb_t * load(const char * path) {
+	return load_pid(path, avail_pid++);
+}
+
+struct pcb_t * load_pid(const char * path, uint32_t pid) {
 	/* Create new PCB for the new process */
 	struct pcb_t * proc = (struct pcb_t * )malloc(sizeof(struct pcb_t));
-	proc->pid = avail_pid;
-	avail_pid++;
+	proc->pid = pid;
 	proc->page_table =
 		(struct page_table_t*)malloc(sizeof(struct page_table_t));
 	proc->bp = PAGE_SIZE;
 	proc->pc = 0;
 
-	/* Read process code from file */
-	FILE * file;
-	if ((file = fopen(path, "r")) == NULL) {
-		printf("Cannot find process description at '%s'\n", path);
-		exit(1);		
-	}
-	snprintf(proc->path, 2*sizeof(path)+1, "%s", path);
-	char opcode[10];
-	proc->code = (struct code_seg_t*)malloc(sizeof(struct code_seg_t));
-	fscanf(file, "%u %u", &proc->priority, &proc->code->size);
-	proc->code->text = (struct inst_t*)malloc(
-		sizeof(struct inst_t) * proc->code->size
-	);
-	uint32_t i = 0;
-	char buf[200];
-	for (i = 0; i < proc->code->size; i++) {
-		fscanf(file, "%s", opcode);
-		proc->code->text[i].opcode = get_opcode(opcode);
-		switch(proc->code->text[i].opcode) {
-		case CALC:
-			break;
-		case ALLOC:
-			fscanf(
-				file,
-				"%u %u\n",
-				&proc->code->text[i].arg_0,
-				&proc->code->text[i].arg_1
-			);
-			break;
-		case FREE:
-			fscanf(file, "%u\n", &proc->code->text[i].arg_0);
-			break;
-		case READ:
-		case WRITE:
-			fscanf(
-				file,
-				"%u %u %u\n",
-				&proc->code->text[i].arg_0,
-				&proc->code->text[i].arg_1,
-				&proc->code->text[i].arg_2
-			);
-			break;	
-		case SYSCALL:
-			fgets(buf, sizeof(buf), file);
-			sscanf(buf, "%d%d%d%d",
-			           &proc->code->text[i].arg_0,
-			           &proc->code->text[i].arg_1,
-			           &proc->code->text[i].arg_2,
-			           &proc->code->text[i].arg_3
-			);
-			break;
-		default:
-			printf("Opcode: %s\n", opcode);
-			exit(1);
-		}
-	}
+	/* Share the code of the program, mapped or read on first use */
+	snprintf(proc->path, sizeof(proc->path), "%s", path);
+	struct code_cache * code = get_code(path);
+	proc->code = &code->code;
+	proc->priority = code->priority;
+	/* Every instruction takes one time slot */
+	proc->burst_time = proc->code->size;
+	proc->remaining_time = proc->code->size;
+	proc->arrival_time = 0;
+	proc->deadline = 0;
+	proc->tickets = 0;
+	proc->alarm.pprev = NULL;
+	proc->sleeping = 0;
+	proc->perf = calloc(1, sizeof(struct perf_counters));
 	return proc;
 }
-
-
-
@@ -0,0 +1,201 @@
+#include "manifest.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(struct manifest_header) == 24,
+	"struct manifest_header is not packed");
+_Static_assert(sizeof(struct manifest_record) == 16,
+	"struct manifest_record is not packed");
+
+struct manifest {
+	FILE * file;
+	char path[100];
+	uint64_t left;		/* Records left, UINT64_MAX for a text manifest */
+	int inline_cfg;		/* Lines of the configure file, how many */
+	int binary;
+	char (* names)[MANIFEST_NAME];	/* Programs of a binary manifest */
+	uint32_t nr_names;
+};
+
+/*
+ * Read the next process line of [file] into [rec], with a relative
+ * deadline, and its program name into [program]. Blank lines are skipped.
+ * Return 1 at the end of the file.
+ */
+static int read_line(FILE * file, const char * path, struct ld_record * rec,
+		char * program) {
+	char line[256];
+	int valid;
+	/* [start time] [program] [priority] [deadline], the deadline is
+	 * optional and counted in time slots from the start time */
+	do {
+		if (fgets(line, sizeof(line), file) == NULL)
+			return 1;
+	} while (sscanf(line, "%99s", program) != 1);
+	rec->prio = 0;
+	rec->deadline = 0;
+#ifdef MLQ_SCHED
+	valid = sscanf(line, "%lu %99s %lu %lu", &rec->start_time,
+		program, &rec->prio, &rec->deadline) >= 3;
+#else
+	valid = sscanf(line, "%lu %99s %lu", &rec->start_time,
+		program, &rec->deadline) >= 2;
+#endif
+	if (!valid) {
+		printf("Invalid process line in %s: %s", path, line);
+		exit(1);
+	}
+	return 0;
+}
+
+static struct manifest * manifest_new(FILE * file, const char * path) {
+	struct manifest * m = (struct manifest*)calloc(1, sizeof(struct manifest));
+	m->file = file;
+	snprintf(m->path, sizeof(m->path), "%s", path);
+	m->left = UINT64_MAX;
+	return m;
+}
+
+struct manifest * manifest_open(const char * path) {
+	struct manifest_header hdr;
+	struct manifest * m;
+	FILE * file;
+	if ((file = fopen(path, "rb")) == NULL) {
+		printf("Cannot find manifest at %s\n", path);
+		exit(1);
+	}
+	/* Processes are read as the loader goes, from a large buffer */
+	setvbuf(file, NULL, _IOFBF, 1 << 16);
+	m = manifest_new(file, path);
+	/* Anything not starting with the magic is read as text */
+	if (fread(&hdr, sizeof(hdr), 1, file) != 1 || hdr.magic != MANIFEST_MAGIC) {
+		rewind(file);
+		return m;
+	}
+	if (hdr.version != MANIFEST_VERSION) {
+		printf("Manifest %s has version %u, expected %u, rebuild it with pasm\n",
+			path, hdr.version, MANIFEST_VERSION);
+		exit(1);
+	}
+	m->binary = 1;
+	m->left = hdr.count;
+	m->nr_names = hdr.nr_programs;
+	m->names = malloc((m->nr_names ? m->nr_names : 1) * MANIFEST_NAME);
+	if (fread(m->names, MANIFEST_NAME, m->nr_names, file) != m->nr_names) {
+		printf("Manifest %s is truncated\n", path);
+		exit(1);
+	}
+	uint32_t i;
+	for (i = 0; i < m->nr_names; i++)
+		m->names[i][MANIFEST_NAME - 1] = '\0';
+	return m;
+}
+
+struct manifest * manifest_inline(FILE * file, const char * path, int count) {
+	struct manifest * m = manifest_new(file, path);
+	m->inline_cfg = count;
+	m->left = count;
+	return m;
+}
+
+int manifest_next(struct manifest * m, struct ld_record * rec) {
+	char program[100];
+	if (m->left == 0)
+		return 1;
+	if (m->binary) {
+		struct manifest_record r;
+		if (fread(&r, sizeof(r), 1, m->file) != 1) {
+			printf("Manifest %s is truncated\n", m->path);
+			exit(1);
+		}
+		if (r.program >= m->nr_names) {
+			printf("Manifest %s is corrupt\n", m->path);
+			exit(1);
+		}
+		rec->start_time = r.start_time;
+		rec->prio = r.prio;
+		rec->deadline = r.deadline;
+		snprintf(program, sizeof(program), "%s", m->names[r.program]);
+	}else if (read_line(m->file, m->path, rec, program) != 0) {
+		if (m->inline_cfg) {
+			printf("Configure file %s lists fewer than %d processes\n",
+				m->path, m->inline_cfg);
+			exit(1);
+		}
+		m->left = 0;
+		return 1;
+	}
+	if (m->left != UINT64_MAX)
+		m->left--;
+	snprintf(rec->path, sizeof(rec->path), "input/proc/%.88s", program);
+	if (rec->deadline != 0)
+		rec->deadline += rec->start_time;
+	return 0;
+}
+
+void manifest_close(struct manifest * m) {
+	fclose(m->file);
+	free(m->names);
+	free(m);
+}
+
+/* Index of [program] in [names], added if missing */
+static uint32_t name_index(char (** names)[MANIFEST_NAME], uint32_t * nr_names,
+		const char * program) {
+	uint32_t i;
+	for (i = 0; i < *nr_names; i++)
+		if (!strcmp((*names)[i], program))
+			return i;
+	*names = realloc(*names, (*nr_names + 1) * MANIFEST_NAME);
+	memset((*names)[i], 0, MANIFEST_NAME);
+	strcpy((*names)[i], program);
+	(*nr_names)++;
+	return i;
+}
+
+int compile_manifest(const char * src, const char * dst) {
+	struct manifest_header hdr = { MANIFEST_MAGIC, MANIFEST_VERSION, 0, 0, 0 };
+	char (* names)[MANIFEST_NAME] = NULL;
+	struct ld_record rec;
+	char program[100];
+	FILE * in, * out;
+	if ((in = fopen(src, "r")) == NULL) {
+		printf("Cannot find manifest at %s\n", src);
+		exit(1);
+	}
+	/* The names come first, gather them in a first pass */
+	while (read_line(in, src, &rec, program) == 0) {
+		if (strlen(program) >= MANIFEST_NAME) {
+			printf("Program name %s in %s is longer than %d bytes\n",
+				program, src, MANIFEST_NAME - 1);
+			exit(1);
+		}
+		if (rec.start_time > UINT32_MAX || rec.prio > UINT32_MAX ||
+		    rec.deadline > UINT32_MAX) {
+			printf("Process line in %s does not fit a binary manifest\n", src);
+			exit(1);
+		}
+		name_index(&names, &hdr.nr_programs, program);
+		hdr.count++;
+	}
+	if ((out = fopen(dst, "wb")) == NULL) {
+		fclose(in);
+		free(names);
+		return -1;
+	}
+	setvbuf(out, NULL, _IOFBF, 1 << 16);
+	int err = fwrite(&hdr, sizeof(hdr), 1, out) != 1 ||
+		fwrite(names, MANIFEST_NAME, hdr.nr_programs, out) != hdr.nr_programs;
+	rewind(in);
+	while (!err && read_line(in, src, &rec, program) == 0) {
+		struct manifest_record r = {
+			rec.start_time,
+			name_index(&names, &hdr.nr_programs, program),
+			rec.prio, rec.deadline
+		};
+		err = fwrite(&r, sizeof(r), 1, out) != 1;
+	}
+	fclose(in);
+	free(names);
+	return fclose(out) != 0 || err ? -1 : 0;
+}
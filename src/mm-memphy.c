@@ -15,10 +15,14 @@
    Đỗ Quang Long      2311896     Scheduler 
 */
 #include "mm.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Guards the free frame lists, CPUs allocate and retire processes at once */
+static pthread_mutex_t fp_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  *  MEMPHY_mv_csr - move MEMPHY cursor
  *  @mp: memphy struct
@@ -120,6 +124,65 @@ int MEMPHY_write(struct memphy_struct *mp, int addr, BYTE data)
    return 0;
 }
 
+/*
+ *  MEMPHY_read_blk - read a run of bytes from MEMPHY device
+ *  @mp: memphy struct
+ *  @addr: address of the first byte
+ *  @buf: obtained bytes
+ *  @len: number of bytes
+ */
+int MEMPHY_read_blk(struct memphy_struct *mp, int addr, BYTE *buf, int len)
+{
+   int i;
+
+   if (mp == NULL || addr < 0 || addr + len > mp->maxsz)
+      return -1;
+
+   if (mp->rdmflg) {
+      memcpy(buf, mp->storage + addr, len);
+      return 0;
+   }
+
+   /* Sequential access device */
+   for (i = 0; i < len; i++)
+      if (MEMPHY_read(mp, addr + i, &buf[i]) != 0)
+         return -1;
+
+   return 0;
+}
+
+/*
+ *  MEMPHY_write_blk - write a run of bytes to MEMPHY device
+ *  @mp: memphy struct
+ *  @addr: address of the first byte
+ *  @buf: written bytes, NULL to write [fill] to every byte
+ *  @fill: byte written when [buf] is NULL
+ *  @len: number of bytes
+ */
+int MEMPHY_write_blk(struct memphy_struct *mp, int addr, const BYTE *buf,
+                     BYTE fill, int len)
+{
+   int i;
+
+   if (mp == NULL || addr < 0 || addr + len > mp->maxsz)
+      return -1;
+
+   if (mp->rdmflg) {
+      if (buf != NULL)
+         memcpy(mp->storage + addr, buf, len);
+      else
+         memset(mp->storage + addr, fill, len);
+      return 0;
+   }
+
+   /* Sequential access device */
+   for (i = 0; i < len; i++)
+      if (MEMPHY_write(mp, addr + i, buf != NULL ? buf[i] : fill) != 0)
+         return -1;
+
+   return 0;
+}
+
 /*
  *  MEMPHY_format-format MEMPHY device
  *  @mp: memphy struct
@@ -154,13 +217,19 @@ int MEMPHY_format(struct memphy_struct *mp, int pagesz)
 
 int MEMPHY_get_freefp(struct memphy_struct *mp, int *retfpn)
 {
-   struct framephy_struct *fp = mp->free_fp_list;
+   struct framephy_struct *fp;
 
+   pthread_mutex_lock(&fp_lock);
+   fp = mp->free_fp_list;
    if (fp == NULL)
+   {
+      pthread_mutex_unlock(&fp_lock);
       return -1;
+   }
 
    *retfpn = fp->fpn;
    mp->free_fp_list = fp->fp_next;
+   pthread_mutex_unlock(&fp_lock);
 
    /* MEMPHY is iteratively used up until its exhausted
     * No garbage collector acting then it not been released
@@ -195,13 +264,14 @@ int MEMPHY_dump(struct memphy_struct *mp)
 
 int MEMPHY_put_freefp(struct memphy_struct *mp, int fpn)
 {
-   struct framephy_struct *fp = mp->free_fp_list;
    struct framephy_struct *newnode = malloc(sizeof(struct framephy_struct));
 
    /* Create new node with value fpn */
    newnode->fpn = fpn;
-   newnode->fp_next = fp;
+   pthread_mutex_lock(&fp_lock);
+   newnode->fp_next = mp->free_fp_list;
    mp->free_fp_list = newnode;
+   pthread_mutex_unlock(&fp_lock);
 
    return 0;
 }
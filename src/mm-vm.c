@@ -17,6 +17,7 @@
 
 #include "string.h"
 #include "mm.h"
+#include "perf.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <pthread.h>
@@ -61,6 +62,9 @@ int __mm_swap_page(struct pcb_t *caller, int vicfpn , int swpfpn)
 {
     BYTE buf1, buf2;
 
+    perf_count(caller, PERF_SWAPOUT);
+    perf_count(caller, PERF_SWAPIN);
+
     // Read Ram into buf1
     MEMPHY_read(caller->mram, vicfpn * PAGING_PAGESZ, &buf1);
 
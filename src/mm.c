@@ -16,6 +16,7 @@
 */
 
 #include "mm.h"
+#include "tlb.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -73,6 +74,7 @@ int init_pte(uint32_t *pte,
  */
 int pte_set_swap(uint32_t *pte, int swptyp, int swpoff)
 {
+  tlb_invalidate_pte(pte);
   SETBIT(*pte, PAGING_PTE_PRESENT_MASK);
   SETBIT(*pte, PAGING_PTE_SWAPPED_MASK);
 
@@ -89,6 +91,7 @@ int pte_set_swap(uint32_t *pte, int swptyp, int swpoff)
  */
 int pte_set_fpn(uint32_t *pte, int fpn)
 {
+  tlb_invalidate_pte(pte);
   SETBIT(*pte, PAGING_PTE_PRESENT_MASK);
   CLRBIT(*pte, PAGING_PTE_SWAPPED_MASK);
 
@@ -123,15 +126,15 @@ int vmap_page_range(struct pcb_t *caller,           // process call
     
     // Thiết lập PTE cho trang hiện tại với frame số từ danh sách frames.
     pte_set_fpn(&caller->mm->pgd[curr_page], frames->fpn);
+
+    /* Tracking for later page replacement activities (if needed)
+     * Enqueue new usage page */
+    enlist_pgn_node(&caller->mm->fifo_pgn, curr_page);
     
     // Tiến đến frame kế tiếp
     frames = frames->fp_next;
   }
 
-  /* Tracking for later page replacement activities (if needed)
-   * Enqueue new usage page */
-  enlist_pgn_node(&caller->mm->fifo_pgn, pgn + pgit);
-
   return 0;
 }
 
@@ -273,13 +276,16 @@ int init_mm(struct mm_struct *mm, struct pcb_t *caller)
 {
   struct vm_area_struct *vma0 = malloc(sizeof(struct vm_area_struct));
 
-  mm->pgd = malloc(PAGING_MAX_PGN * sizeof(uint32_t));
+  mm->pgd = calloc(PAGING_MAX_PGN, sizeof(uint32_t));
+  mm->fifo_pgn = NULL;
+  mm->tlb_cpu = -1;
 
   /* By default the owner comes with at least one vma */
   vma0->vm_id = 0;
   vma0->vm_start = 0;
   vma0->vm_end = vma0->vm_start;
   vma0->sbrk = vma0->vm_start;
+  vma0->vm_freerg_list = NULL;
   struct vm_rg_struct *first_rg = init_vm_rg(vma0->vm_start, vma0->vm_end);
   enlist_vm_rg_node(&vma0->vm_freerg_list, first_rg);
 
@@ -294,6 +300,37 @@ int init_mm(struct mm_struct *mm, struct pcb_t *caller)
   return 0;
 }
 
+/*
+ *free_mm - release the bookkeeping of a finished process
+ *@mm: self mm
+ *
+ *Its frames go back to MEMPHY through free_pcb_memph() first
+ */
+void free_mm(struct mm_struct *mm)
+{
+  struct vm_area_struct *vma, *next_vma;
+  struct vm_rg_struct *rg, *next_rg;
+  struct pgn_t *pg, *next_pg;
+
+  for (vma = mm->mmap; vma != NULL; vma = next_vma)
+  {
+    next_vma = vma->vm_next;
+    for (rg = vma->vm_freerg_list; rg != NULL; rg = next_rg)
+    {
+      next_rg = rg->rg_next;
+      free(rg);
+    }
+    free(vma);
+  }
+  for (pg = mm->fifo_pgn; pg != NULL; pg = next_pg)
+  {
+    next_pg = pg->pg_next;
+    free(pg);
+  }
+  free(mm->pgd);
+  free(mm);
+}
+
 struct vm_rg_struct *init_vm_rg(int rg_start, int rg_end)
 {
   struct vm_rg_struct *rgnode = malloc(sizeof(struct vm_rg_struct));
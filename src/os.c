@@ -4,15 +4,33 @@
 #include "sched.h"
 #include "loader.h"
 #include "mm.h"
+#include "event.h"
+#include "replay.h"
+#include "tlb.h"
+#include "perf.h"
+#include "manifest.h"
 
 #include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
 static int time_slot;
 static int num_cpus;
 static int done = 0;
+static int rq_mode = SCHED_RQ_GLOBAL;
+static char sched_policy[64] = "";	/* Empty for the scheduler's default */
+static int aging = 0;
+static int quota = 0;
+static int tickless = 0;
+static int event_engine = 0;
+static uint32_t ipt = 1;	/* Instructions a CPU runs per time slot */
+static int ld_pool = 0;		/* Threads prefetching processes, 0 for none */
+static int rr_mode = RR_OFF;
+static char rr_path[100];
+static char perf_path[100];	/* CSV dump of the counters, empty for none */
+static char manifest_path[100];	/* Processes to load, empty for the config */
 
 #ifdef MM_PAGING
 static int memramsz;
@@ -29,131 +47,511 @@ struct mmpaging_ld_args {
 };
 #endif
 
-static struct ld_args{
-	char ** path;
-	unsigned long * start_time;
-#ifdef MLQ_SCHED
-	unsigned long * prio;
-#endif
-} ld_processes;
 int num_processes;
 
 struct cpu_args {
 	struct timer_id_t * timer_id;
 	int id;
+	/* What the CPU carries from one time slot to the next */
+	struct pcb_t * proc;
+	int time_left;
+	int preempt;
+	uint32_t dispatched;	/* PID dispatched in the last slot, 0 if none */
+	uint64_t executed;	/* Instructions run so far */
+	uint64_t end_slot;	/* One past the last slot it ran instructions in */
+};
+
+/* Where a CPU stands after a time slot, see cpu_step() */
+enum cpu_state {
+	CPU_BUSY,	/* Ran up to ipt instructions */
+	CPU_IDLE,	/* Found nothing to run */
+	CPU_STOPPED,	/* Found nothing to run, nothing to load or wake up */
 };
 
+static int nr_live = 0;	/* Loaded processes that have not finished yet */
+
+/* killall frees the processes it takes off the ready queues */
+static void procs_killed(int killed) {
+	__atomic_sub_fetch(&nr_live, killed, __ATOMIC_RELAXED);
+}
+
+/*
+ * Run one time slot of a CPU: retire, put back or dispatch its process,
+ * then execute up to ipt instructions of it. Both engines drive the CPUs through
+ * here and only differ in how they interleave the slots.
+ */
+static enum cpu_state cpu_step(struct cpu_args * cpu) {
+	int id = cpu->id;
+	cpu->dispatched = 0;
+	perf_switch(id);
+	/* Check the status of current process */
+	if (cpu->proc == NULL) {
+		/* No process is running, the we load new process from
+	 	* ready queue */
+		cpu->proc = get_cpu_proc(id);
+		if (cpu->proc == NULL) {
+			if (done && !timer_pending()) {
+				printf("\tCPU %d stopped (no more processes)\n", id);
+				return CPU_STOPPED;
+			}
+			return CPU_IDLE;
+		}
+	}else if (cpu->proc->pc == cpu->proc->code->size) {
+		/* The porcess has finish it job */
+		printf("\tCPU %d: Processed %2d has finished\n",
+			id, cpu->proc->pid);
+		sched_exit(cpu->proc, current_time());
+		perf_exit(cpu->proc);
+		release_code(cpu->proc->code);
+#ifdef MM_PAGING
+		free_pcb_memph(cpu->proc);
+		free_mm(cpu->proc->mm);
+#endif
+		free(cpu->proc->page_table);
+		free(cpu->proc);
+		__atomic_sub_fetch(&nr_live, 1, __ATOMIC_RELAXED);
+		cpu->proc = get_cpu_proc(id);
+		cpu->time_left = 0;
+	}else if (cpu->preempt) {
+		/* The process has done its job in current time slot */
+		printf("\tCPU %d: Put process %2d to run queue\n",
+			id, cpu->proc->pid);
+		perf_count(cpu->proc, PERF_PREEMPT);
+		put_cpu_proc(id, cpu->proc);
+		cpu->proc = get_cpu_proc(id);
+		cpu->time_left = 0;
+	}
+
+	/* Recheck process status after loading new process */
+	if (cpu->proc == NULL && done && !timer_pending()) {
+		/* No process to run, exit */
+		printf("\tCPU %d stopped\n", id);
+		return CPU_STOPPED;
+	}else if (cpu->proc == NULL) {
+		/* There may be new processes to run in
+		 * next time slots, just skip current slot */
+		return CPU_IDLE;
+	}else if (cpu->time_left == 0) {
+		printf("\tCPU %d: Dispatched process %2d\n",
+			id, cpu->proc->pid);
+		cpu->dispatched = cpu->proc->pid;
+		perf_count(cpu->proc, PERF_DISPATCH);
+		cpu->time_left = time_slot;
+	}
+
+	/* Run current process, the whole slot is one tick to the scheduler */
+	uint32_t pc = cpu->proc->pc;
+#ifdef MM_PAGING
+	tlb_switch(id, cpu->proc);
+#endif
+	run_slice(cpu->proc, ipt);
+	cpu->executed += cpu->proc->pc - pc;
+	cpu->end_slot = current_time() + 1;
+	perf_count(cpu->proc, PERF_BUSY);
+	cpu->time_left--;
+	cpu->preempt = sched_tick(id, cpu->proc, cpu->time_left);
+	if (cpu->proc->sleeping) {
+		/* It set an alarm, the timer puts it back when it rings */
+		printf("\tCPU %d: Process %2d went to sleep\n",
+			id, cpu->proc->pid);
+		cpu->proc = NULL;
+		cpu->time_left = 0;
+	}else if (!cpu->preempt && cpu->time_left == 0) {
+		/* Non-preemptive policies keep the CPU past the quantum */
+		cpu->time_left = time_slot;
+	}
+	return CPU_BUSY;
+}
+
+/*
+ * In the threaded engine the CPUs start a slot only once the loader is
+ * done with it, so a process is always visible to the CPUs from its
+ * arrival slot on. This is the order the event engine runs the slot in.
+ */
+static uint64_t ld_ready = 0;	/* Slots the loader is done with */
+static pthread_mutex_t ld_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ld_cond = PTHREAD_COND_INITIALIZER;
+
+static void ld_publish(uint64_t ready) {
+	pthread_mutex_lock(&ld_lock);
+	__atomic_store_n(&ld_ready, ready, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&ld_cond);
+	pthread_mutex_unlock(&ld_lock);
+}
+
+static void ld_wait(void) {
+	uint64_t now = current_time();
+	if (__atomic_load_n(&ld_ready, __ATOMIC_ACQUIRE) > now)
+		return;
+	pthread_mutex_lock(&ld_lock);
+	while (__atomic_load_n(&ld_ready, __ATOMIC_ACQUIRE) <= now)
+		pthread_cond_wait(&ld_cond, &ld_lock);
+	pthread_mutex_unlock(&ld_lock);
+}
 
 static void * cpu_routine(void * args) {
-	struct timer_id_t * timer_id = ((struct cpu_args*)args)->timer_id;
-	int id = ((struct cpu_args*)args)->id;
-	/* Check for new process in ready queue */
-	int time_left = 0;
-	struct pcb_t * proc = NULL;
+	struct cpu_args * cpu = (struct cpu_args*)args;
+	enum cpu_state state;
 	while (1) {
-		/* Check the status of current process */
-		if (proc == NULL) {
-			/* No process is running, the we load new process from
-		 	* ready queue */
-			proc = get_proc();
-			if (proc == NULL) {
-				if (done) {
-					printf("\tCPU %d stopped (no more processes)\n", id);
-					break;
-				}
-				next_slot(timer_id);
-				continue;
-            }
-		}else if (proc->pc == proc->code->size) {
-			/* The porcess has finish it job */
-			printf("\tCPU %d: Processed %2d has finished\n",
-				id ,proc->pid);
-			free(proc);
-			proc = get_proc();
-			time_left = 0;
-		}else if (time_left == 0) {
-			/* The process has done its job in current time slot */
-			printf("\tCPU %d: Put process %2d to run queue\n",
-				id, proc->pid);
-			put_proc(proc);
-			proc = get_proc();
-		}
-		
-		/* Recheck process status after loading new process */
-		if (proc == NULL && done) {
-			/* No process to run, exit */
-			printf("\tCPU %d stopped\n", id);
+		ld_wait();
+		rr_begin(cpu->id);
+		state = cpu_step(cpu);
+		rr_end(cpu->id, cpu->dispatched, state == CPU_STOPPED);
+		if (state == CPU_STOPPED)
 			break;
-		}else if (proc == NULL) {
-			/* There may be new processes to run in
-			 * next time slots, just skip current slot */
-			next_slot(timer_id);
-			continue;
-		}else if (time_left == 0) {
-			printf("\tCPU %d: Dispatched process %2d\n",
-				id, proc->pid);
-			time_left = time_slot;
-		}
-		
-		/* Run current process */
-		run(proc);
-		time_left--;
-		next_slot(timer_id);
+		if (state == CPU_IDLE)
+			next_idle_slot(cpu->timer_id, UINT64_MAX);
+		else
+			next_slot(cpu->timer_id);
 	}
-	detach_event(timer_id);
+	detach_event(cpu->timer_id);
 	pthread_exit(NULL);
 }
 
-static void * ld_routine(void * args) {
+/*
+ * The processes are read from the manifest as the loader goes, into a
+ * window of the LD_WINDOW processes that follow the last one loaded, so
+ * the loader holds a bounded number of them however long the manifest.
+ * Process i sits in ld_window[i % LD_WINDOW] while
+ * ld_next <= i < ld_read.
+ *
+ * With ldpool=N, N threads prefetch the processes of the window ahead of
+ * their arrival: they read or map the program and build its pcb, and the
+ * loader, still stepped by the timer, only publishes them once they are
+ * due. A slot then takes every process due in it instead of one.
+ */
+#define LD_WINDOW	64
+
+static struct ld_slot {
+	struct ld_record rec;
+	struct pcb_t * proc;	/* Prepared by the pool, NULL until then */
+} ld_window[LD_WINDOW];
+static struct manifest * ld_manifest;
+static int ld_next = 0;		/* Index of the next process to load */
+static int ld_read = 0;		/* Processes read from the manifest */
+static int ld_claimed = 0;	/* Index the pool prepares next */
+static int ld_eof = 0;		/* Every process was read */
+static pthread_t * ld_workers;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+
+/* Read the next process into the window, with pool_lock held. Return
+ * its index, or -1 past the last one */
+static int ld_fetch(void) {
+	struct ld_slot * slot = &ld_window[ld_read % LD_WINDOW];
+	if (ld_eof || manifest_next(ld_manifest, &slot->rec) != 0) {
+		ld_eof = 1;
+		return -1;
+	}
+	slot->proc = NULL;
+	return ld_read++;
+}
+
+/* Create the process of [rec], the [i]th of the manifest */
+static struct pcb_t * ld_prepare(void * args, const struct ld_record * rec, int i) {
 #ifdef MM_PAGING
 	struct memphy_struct* mram = ((struct mmpaging_ld_args *)args)->mram;
 	struct memphy_struct** mswp = ((struct mmpaging_ld_args *)args)->mswp;
 	struct memphy_struct* active_mswp = ((struct mmpaging_ld_args *)args)->active_mswp;
-	struct timer_id_t * timer_id = ((struct mmpaging_ld_args *)args)->timer_id;
-#else
-	struct timer_id_t * timer_id = (struct timer_id_t*)args;
 #endif
-	int i = 0;
-	printf("ld_routine\n");
-	while (i < num_processes) {
-		struct pcb_t * proc = load(ld_processes.path[i]);
+	/* PIDs follow the manifest, whichever thread loads the process */
+	struct pcb_t * proc = load_pid(rec->path, i + 1);
 #ifdef MLQ_SCHED
-		proc->prio = ld_processes.prio[i];
+	proc->prio = rec->prio;
 #endif
-		while (current_time() < ld_processes.start_time[i]) {
-			next_slot(timer_id);
-		}
+	proc->deadline = rec->deadline;
+	/* Burst and remaining time are counted in slots */
+	proc->burst_time = (proc->code->size + ipt - 1) / ipt;
+	proc->remaining_time = proc->burst_time;
 #ifdef MM_PAGING
-		proc->mm = malloc(sizeof(struct mm_struct));
-		init_mm(proc->mm, proc);
-		proc->mram = mram;
-		proc->mswp = mswp;
-		proc->active_mswp = active_mswp;
+	proc->mm = calloc(1, sizeof(struct mm_struct));
+	init_mm(proc->mm, proc);
+	proc->mram = mram;
+	proc->mswp = mswp;
+	proc->active_mswp = active_mswp;
 #endif
-		printf("\tLoaded a process at %s, PID: %d PRIO: %ld\n",
-			ld_processes.path[i], proc->pid, ld_processes.prio[i]);
+	return proc;
+}
+
+static void * ld_worker(void * args) {
+	int i;
+	while (1) {
+		pthread_mutex_lock(&pool_lock);
+		while (!ld_eof && ld_claimed - ld_next >= LD_WINDOW)
+			pthread_cond_wait(&pool_cond, &pool_lock);
+		if (ld_claimed == ld_read && ld_fetch() < 0) {
+			pthread_mutex_unlock(&pool_lock);
+			break;
+		}
+		i = ld_claimed++;
+		/* The slot is ours until the loader takes the process */
+		struct ld_slot * slot = &ld_window[i % LD_WINDOW];
+		pthread_mutex_unlock(&pool_lock);
+
+		struct pcb_t * proc = ld_prepare(args, &slot->rec, i);
+		pthread_mutex_lock(&pool_lock);
+		slot->proc = proc;
+		pthread_cond_broadcast(&pool_cond);
+		pthread_mutex_unlock(&pool_lock);
+	}
+	return NULL;
+}
+
+static void ld_pool_start(void * args) {
+	int i;
+	ld_workers = (pthread_t*)malloc(ld_pool * sizeof(pthread_t));
+	for (i = 0; i < ld_pool; i++)
+		pthread_create(&ld_workers[i], NULL, ld_worker, args);
+}
+
+static void ld_pool_stop(void) {
+	int i;
+	for (i = 0; i < ld_pool; i++)
+		pthread_join(ld_workers[i], NULL);
+	free(ld_workers);
+}
+
+/*
+ * Run one time slot of the loader: load the next process if it is due, or
+ * with a pool every process due.
+ * @return: the next slot the loader has work in, or 0 once every process
+ *          was loaded and the loader is done
+ */
+static uint64_t ld_step(void * args) {
+	struct ld_slot * slot = &ld_window[ld_next % LD_WINDOW];
+	pthread_mutex_lock(&pool_lock);
+	if (ld_next == ld_read && ld_fetch() < 0) {
+		pthread_mutex_unlock(&pool_lock);
+		if (ld_pool > 0)
+			ld_pool_stop();
+		manifest_close(ld_manifest);
+		done = 1;
+		return 0;
+	}
+	pthread_mutex_unlock(&pool_lock);
+	if (current_time() < slot->rec.start_time)
+		return slot->rec.start_time;
+
+	while (1) {
+		struct pcb_t * proc;
+		if (ld_pool > 0) {
+			/* Wait for the pool to prepare it */
+			pthread_mutex_lock(&pool_lock);
+			while (slot->proc == NULL)
+				pthread_cond_wait(&pool_cond, &pool_lock);
+			proc = slot->proc;
+			pthread_mutex_unlock(&pool_lock);
+		}else{
+			proc = ld_prepare(args, &slot->rec, ld_next);
+		}
+		proc->arrival_time = current_time();
+		printf("\tLoaded a process at %s, PID: %d PRIO: %lu\n",
+			proc->path, proc->pid, slot->rec.prio);
+		__atomic_add_fetch(&nr_live, 1, __ATOMIC_RELAXED);
 		add_proc(proc);
-		free(ld_processes.path[i]);
-		i++;
-		next_slot(timer_id);
+
+		/* Free the slot and see whether the next one is due too */
+		pthread_mutex_lock(&pool_lock);
+		ld_next++;
+		pthread_cond_broadcast(&pool_cond);
+		slot = &ld_window[ld_next % LD_WINDOW];
+		if (ld_pool == 0 || (ld_next == ld_read && ld_fetch() < 0) ||
+		    current_time() < slot->rec.start_time) {
+			pthread_mutex_unlock(&pool_lock);
+			break;
+		}
+		pthread_mutex_unlock(&pool_lock);
 	}
-	free(ld_processes.path);
-	free(ld_processes.start_time);
-	done = 1;
+	return current_time() + 1;
+}
+
+static void * ld_routine(void * args) {
+#ifdef MM_PAGING
+	struct timer_id_t * timer_id = ((struct mmpaging_ld_args *)args)->timer_id;
+#else
+	struct timer_id_t * timer_id = (struct timer_id_t*)args;
+#endif
+	uint64_t wake;
+	printf("ld_routine\n");
+	while ((wake = ld_step(args)) != 0) {
+		ld_publish(current_time() + 1);
+		next_idle_slot(timer_id, wake);
+	}
+	ld_publish(UINT64_MAX);
 	detach_event(timer_id);
 	pthread_exit(NULL);
 }
 
-static void read_config(const char * path) {
+/*
+ * Single threaded engine. Rather than one thread per CPU lock-stepped by
+ * the timer, the loader and the CPUs are stepped from one event queue in
+ * slot order, the loader first and then the CPUs by id. That is the order
+ * the threaded engine runs a slot in, except that its CPUs race with each
+ * other. A CPU with nothing to run leaves the queue while every process
+ * alive sleeps on a timer, and is brought back by the next loader or
+ * timer event.
+ */
+static void run_events(struct cpu_args * cpus, void * ld_args) {
+	struct event_queue_t events = { 0 };
+	struct event ev;
+	char * asleep = calloc(num_cpus, sizeof(char));
+	uint64_t timer_due = UINT64_MAX;	/* Earliest EVENT_TIMER queued */
+	int i;
+
+	printf("ld_routine\n");
+	event_push(&events, (struct event){ 0, EVENT_LOAD, 0 });
+	for (i = 0; i < num_cpus; i++)
+		event_push(&events, (struct event){ 0, EVENT_CPU, i });
+
+	while (event_pop(&events, &ev)) {
+		if (ev.time > current_time())
+			advance_time(ev.time);
+		switch (ev.kind) {
+		case EVENT_TIMER:
+			/* advance_time() fired it, the woken process needs a CPU */
+			timer_due = UINT64_MAX;
+			break;
+		case EVENT_LOAD: {
+			uint64_t wake = ld_step(ld_args);
+			if (wake != 0)
+				event_push(&events, (struct event){ wake, EVENT_LOAD, 0 });
+			break;
+		}
+		case EVENT_CPU:
+			switch (cpu_step(&cpus[ev.id])) {
+			case CPU_STOPPED:
+				break;
+			case CPU_IDLE:
+				if (nr_live == timer_pending()) {
+					/* Everybody alive sleeps on a timer */
+					asleep[ev.id] = 1;
+					break;
+				}
+				/* Another CPU may put a process back, keep polling */
+				/* fall through */
+			case CPU_BUSY:
+				event_push(&events, (struct event){ ev.time + 1, EVENT_CPU, ev.id });
+				break;
+			}
+			break;
+		}
+		if (ev.kind != EVENT_CPU) {
+			/* Let the sleeping CPUs see the new process, or stop */
+			for (i = 0; i < num_cpus; i++) {
+				if (!asleep[i])
+					continue;
+				asleep[i] = 0;
+				event_push(&events, (struct event){ ev.time, EVENT_CPU, i });
+			}
+		}
+		if (timer_next() < timer_due) {
+			timer_due = timer_next();
+			event_push(&events, (struct event){ timer_due, EVENT_TIMER, 0 });
+		}
+	}
+	free_event_queue(&events);
+	free(asleep);
+}
+
+/*
+ * Run options are [key=value] tokens, given either after the three numbers
+ * on the first line of the configure file or on the command line (which
+ * takes precedence):
+ *   rq=global|percpu   one shared MLQ or per-CPU MLQs with work stealing
+ *   policy=mlq|fifo|sjf|srtf|cfs|edf|stride|lottery
+ *                      scheduling policy, fifo and sjf run every process
+ *                      to completion, srtf preempts on a shorter arrival,
+ *                      cfs shares the CPUs in proportion to prio weights,
+ *                      edf serves the earliest deadline first, stride and
+ *                      lottery share the CPUs in proportion to tickets.
+ *                      The default is mlq, or the single priority queue
+ *                      when MLQ_SCHED is off
+ *   aging=N            with mlq, promote a process one level once it waited
+ *                      N dispatches of its run queue (0, the default, is off)
+ *   quota=0|1          with mlq, serve each level for slot[prio] dispatches
+ *                      per round instead of strict priority (0, the default)
+ *   tickless=0|1       when every CPU is idle, jump straight to the next
+ *                      arrival instead of stepping through empty slots
+ *   ipt=N              instructions a CPU runs per time slot (default 1),
+ *                      time_slot and the scheduler still count in slots
+ *   ldpool=N           prefetch the processes on N threads ahead of their
+ *                      arrival, all processes due in a slot then arrive
+ *                      in it (0, the default, loads one per slot inline)
+ *   engine=thread|event
+ *                      one thread per CPU and for the loader, or all of
+ *                      them stepped on the main thread from an event queue
+ *   manifest=FILE      load the processes listed in FILE, text lines as in
+ *                      the configure file or a binary manifest from
+ *                      pasm -m, instead of those of the configure file
+ *   perf=FILE          also write the performance counters as CSV
+ *   record=FILE        log the order the CPUs ran their slots in, with the
+ *   replay=FILE        processes they dispatched, or run them in the
+ *                      logged order; the CPUs take turns in both modes
+ */
+static void set_option(const char * opt) {
+	char key[32], val[64];
+	if (sscanf(opt, "%31[^=]=%63s", key, val) != 2) {
+		printf("Invalid option '%s', expected key=value\n", opt);
+		exit(1);
+	}
+	if (!strcmp(key, "rq") && !strcmp(val, "global")) {
+		rq_mode = SCHED_RQ_GLOBAL;
+	}else if (!strcmp(key, "rq") && !strcmp(val, "percpu")) {
+		rq_mode = SCHED_RQ_PERCPU;
+	}else if (!strcmp(key, "aging")) {
+		aging = atoi(val);
+	}else if (!strcmp(key, "quota")) {
+		quota = atoi(val);
+	}else if (!strcmp(key, "engine") && !strcmp(val, "thread")) {
+		event_engine = 0;
+	}else if (!strcmp(key, "engine") && !strcmp(val, "event")) {
+		event_engine = 1;
+	}else if (!strcmp(key, "record") || !strcmp(key, "replay")) {
+		rr_mode = !strcmp(key, "record") ? RR_RECORD : RR_REPLAY;
+		snprintf(rr_path, sizeof(rr_path), "%s", val);
+	}else if (!strcmp(key, "ipt")) {
+		if (atoi(val) < 1) {
+			printf("Invalid option '%s', ipt must be at least 1\n", opt);
+			exit(1);
+		}
+		ipt = atoi(val);
+	}else if (!strcmp(key, "ldpool")) {
+		if (atoi(val) < 0) {
+			printf("Invalid option '%s', ldpool must not be negative\n", opt);
+			exit(1);
+		}
+		ld_pool = atoi(val);
+	}else if (!strcmp(key, "manifest")) {
+		snprintf(manifest_path, sizeof(manifest_path), "%s", val);
+	}else if (!strcmp(key, "perf")) {
+		snprintf(perf_path, sizeof(perf_path), "%s", val);
+	}else if (!strcmp(key, "tickless")) {
+		tickless = atoi(val);
+	}else if (!strcmp(key, "policy")) {
+		snprintf(sched_policy, sizeof(sched_policy), "%s", val);
+	}else{
+		printf("Unknown option '%s'\n", opt);
+		exit(1);
+	}
+}
+
+/* Read the configure file up to its process lines, which the loader then
+ * reads from the returned file unless the processes come from a manifest */
+static FILE * read_config(const char * path) {
 	FILE * file;
 	if ((file = fopen(path, "r")) == NULL) {
 		printf("Cannot find configure file at %s\n", path);
 		exit(1);
 	}
-	fscanf(file, "%d %d %d\n", &time_slot, &num_cpus, &num_processes);
-	ld_processes.path = (char**)malloc(sizeof(char*) * num_processes);
-	ld_processes.start_time = (unsigned long*)
-		malloc(sizeof(unsigned long) * num_processes);
+	fscanf(file, "%d %d %d", &time_slot, &num_cpus, &num_processes);
+	/* The rest of the first line may carry run options */
+	char line[256];
+	if (fgets(line, sizeof(line), file) != NULL) {
+		char * tok;
+		for (tok = strtok(line, " \t\r\n"); tok != NULL;
+		     tok = strtok(NULL, " \t\r\n"))
+			set_option(tok);
+	}
 #ifdef MM_PAGING
 	int sit;
 #ifdef MM_FIXED_MEMSZ
@@ -178,41 +576,33 @@ static void read_config(const char * path) {
        fscanf(file, "\n"); /* Final character */
 #endif
 #endif
-
-#ifdef MLQ_SCHED
-	ld_processes.prio = (unsigned long*)
-		malloc(sizeof(unsigned long) * num_processes);
-#endif
-	int i;
-	for (i = 0; i < num_processes; i++) {
-		ld_processes.path[i] = (char*)malloc(sizeof(char) * 100);
-		ld_processes.path[i][0] = '\0';
-		strcat(ld_processes.path[i], "input/proc/");
-		char proc[100];
-#ifdef MLQ_SCHED
-		fscanf(file, "%lu %s %lu\n", &ld_processes.start_time[i], proc, &ld_processes.prio[i]);
-#else
-		fscanf(file, "%lu %s\n", &ld_processes.start_time[i], proc);
-#endif
-		strcat(ld_processes.path[i], proc);
-	}
+	return file;
 }
 
 int main(int argc, char * argv[]) {
 	/* Read config */
-	if (argc != 2) {
-		printf("Usage: os [path to configure file]\n");
+	if (argc < 2) {
+		printf("Usage: os [path to configure file] [option=value ...]\n");
 		return 1;
 	}
 	char path[100];
 	path[0] = '\0';
 	strcat(path, "input/");
 	strcat(path, argv[1]);
-	read_config(path);
+	FILE * cfg = read_config(path);
+	int opt;
+	for (opt = 2; opt < argc; opt++)
+		set_option(argv[opt]);
+	if (manifest_path[0]) {
+		fclose(cfg);
+		ld_manifest = manifest_open(manifest_path);
+	}else{
+		ld_manifest = manifest_inline(cfg, path, num_processes);
+	}
 
 	pthread_t * cpu = (pthread_t*)malloc(num_cpus * sizeof(pthread_t));
 	struct cpu_args * args =
-		(struct cpu_args*)malloc(sizeof(struct cpu_args) * num_cpus);
+		(struct cpu_args*)calloc(num_cpus, sizeof(struct cpu_args));
 	pthread_t ld;
 	
 	/* Init timer */
@@ -222,6 +612,7 @@ int main(int argc, char * argv[]) {
 		args[i].id = i;
 	}
 	struct timer_id_t * ld_event = attach_event();
+	set_tickless(tickless);
 	start_timer();
 
 #ifdef MM_PAGING
@@ -250,28 +641,87 @@ int main(int argc, char * argv[]) {
 #endif
 
 	/* Init scheduler */
+	if (sched_policy[0] != '\0' && sched_set_policy(sched_policy) != 0) {
+		printf("Unknown scheduling policy '%s'\n", sched_policy);
+		exit(1);
+	}
+	sched_set_rq_mode(rq_mode, num_cpus);
+	sched_set_aging(aging);
+	sched_set_quota(quota);
+	sched_set_kill_hook(procs_killed);
 	init_scheduler();
+	perf_init(num_cpus);
+#ifdef MM_PAGING
+	tlb_init(num_cpus);
+#endif
 
 	/* Run CPU and loader */
 #ifdef MM_PAGING
-	pthread_create(&ld, NULL, ld_routine, (void*)mm_ld_args);
+	void * ld_args = (void*)mm_ld_args;
 #else
-	pthread_create(&ld, NULL, ld_routine, (void*)ld_event);
+	void * ld_args = (void*)ld_event;
 #endif
-	for (i = 0; i < num_cpus; i++) {
-		pthread_create(&cpu[i], NULL,
-			cpu_routine, (void*)&args[i]);
-	}
+	struct timespec wall_start, wall_end;
+	clock_gettime(CLOCK_MONOTONIC, &wall_start);
+	if (ld_pool > 0)
+		ld_pool_start(ld_args);
+	if (event_engine) {
+		if (rr_mode != RR_OFF) {
+			printf("record and replay need engine=thread\n");
+			exit(1);
+		}
+		run_events(args, ld_args);
+	}else{
+		rr_open(rr_path, rr_mode, num_cpus);
+		pthread_create(&ld, NULL, ld_routine, ld_args);
+		for (i = 0; i < num_cpus; i++) {
+			pthread_create(&cpu[i], NULL,
+				cpu_routine, (void*)&args[i]);
+		}
 
-	/* Wait for CPU and loader finishing */
-	for (i = 0; i < num_cpus; i++) {
-		pthread_join(cpu[i], NULL);
+		/* Wait for CPU and loader finishing */
+		for (i = 0; i < num_cpus; i++) {
+			pthread_join(cpu[i], NULL);
+		}
+		pthread_join(ld, NULL);
+		rr_close();
 	}
-	pthread_join(ld, NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &wall_end);
+	/* The run lasts up to the last slot a CPU worked in, the engines
+	 * differ in how many empty slots they step through to notice the end */
+	uint64_t slots = 0;
+	for (i = 0; i < num_cpus; i++)
+		if (args[i].end_slot > slots)
+			slots = args[i].end_slot;
 
 	/* Stop timer */
 	stop_timer();
 
+	finish_scheduler();
+
+	/* Simulated and wall clock throughput */
+	uint64_t executed = 0;
+	for (i = 0; i < num_cpus; i++)
+		executed += args[i].executed;
+	double wall = (wall_end.tv_sec - wall_start.tv_sec) +
+		(wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+	printf("\t%lu instructions in %lu slots (%.2f per slot, ipt=%u), "
+		"%.3fs wall clock: %.0f instructions/s, %.0f slots/s\n",
+		(unsigned long)executed, (unsigned long)slots,
+		slots ? (double)executed / slots : 0.0, ipt, wall,
+		wall > 0 ? executed / wall : 0.0, wall > 0 ? slots / wall : 0.0);
+#ifdef MM_PAGING
+	unsigned long hits, misses, flushes;
+	tlb_stats(&hits, &misses, &flushes);
+	printf("\tTLB: %lu hits, %lu misses (%.1f%% hit rate), %lu flushes\n",
+		hits, misses, hits + misses ? 100.0 * hits / (hits + misses) : 0.0,
+		flushes);
+	tlb_free();
+#endif
+	perf_report(slots, perf_path[0] ? perf_path : NULL);
+	perf_free();
+
 	return 0;
 
 }
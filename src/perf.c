@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+
+/* A finished process and what it counted */
+struct perf_proc {
+        uint32_t pid;
+        char name[32];
+        struct perf_counters c;
+};
+
+struct perf_slot {
+        struct perf_counters c;
+        struct perf_proc * procs;	/* Finished on this CPU */
+        int nr_procs, cap;
+} __attribute__((aligned(64)));
+
+static struct perf_slot * slots;
+static int nr_slots;
+
+__thread struct perf_counters * perf_cur;
+static __thread struct perf_slot * cur_slot;
+
+static const char * const opcode_names[NR_OPCODES] = {
+        [CALC] = "calc", [ALLOC] = "alloc", [FREE] = "free",
+        [READ] = "read", [WRITE] = "write", [SYSCALL] = "syscall",
+        [MEMSET] = "memset", [MEMCPY] = "memcpy",
+        [READBLK] = "readblk", [WRITEBLK] = "writeblk",
+};
+
+static const char * const event_names[NR_PERF_EVENTS] = {
+        [PERF_BUSY] = "busy", [PERF_DISPATCH] = "dispatch",
+        [PERF_PREEMPT] = "preempt", [PERF_PGFAULT] = "pgfault",
+        [PERF_SWAPIN] = "swapin", [PERF_SWAPOUT] = "swapout",
+        [PERF_TLB_HIT] = "tlb_hit", [PERF_TLB_MISS] = "tlb_miss",
+        [PERF_SYSCALL] = "syscall",
+};
+
+void perf_init(int nr_cpus) {
+        if (posix_memalign((void **)&slots, 64, nr_cpus * sizeof(struct perf_slot)) != 0) {
+                printf("perf: out of memory for %d CPUs\n", nr_cpus);
+                exit(1);
+        }
+        memset(slots, 0, nr_cpus * sizeof(struct perf_slot));
+        nr_slots = nr_cpus;
+}
+
+void perf_switch(int cpu) {
+        cur_slot = &slots[cpu];
+        perf_cur = &cur_slot->c;
+}
+
+/*
+! Keep the counters of a finished process and release them from its pcb
+* @param proc: the process, about to be freed
+*/
+void perf_exit(struct pcb_t * proc) {
+        struct perf_slot * s = cur_slot;
+        if (proc->perf == NULL)
+                return;
+        if (s != NULL) {
+                // * Make room when the list is full
+                if (s->nr_procs == s->cap) {
+                        int cap = s->cap ? s->cap * 2 : 8;
+                        struct perf_proc * procs = realloc(s->procs, cap * sizeof(struct perf_proc));
+                        if (procs == NULL) {
+                                printf("perf: out of memory growing to %d processes\n", cap);
+                                exit(1);
+                        }
+                        s->procs = procs;
+                        s->cap = cap;
+                }
+                struct perf_proc * p = &s->procs[s->nr_procs++];
+                const char * name = strrchr(proc->path, '/');
+                p->pid = proc->pid;
+                snprintf(p->name, sizeof(p->name), "%.31s", name ? name + 1 : proc->path);
+                p->c = *proc->perf;
+        }
+        free(proc->perf);
+        proc->perf = NULL;
+}
+
+static uint64_t insns(const struct perf_counters * c) {
+        uint64_t n = 0;
+        int i;
+        for (i = 0; i < NR_OPCODES; i++)
+                n += c->insns[i];
+        return n;
+}
+
+/*
+! Print one row of the summary table
+* @param idle: idle slots, or -1 for a process
+*/
+static void print_row(const char * label, const struct perf_counters * c, int64_t idle) {
+        int i;
+        printf("\t%-12s %8lu %7lu", label, (unsigned long)insns(c),
+                (unsigned long)c->events[PERF_BUSY]);
+        if (idle < 0)
+                printf(" %7s", "-");
+        else
+                printf(" %7lu", (unsigned long)idle);
+        for (i = PERF_DISPATCH; i < NR_PERF_EVENTS; i++)
+                printf(" %8lu", (unsigned long)c->events[i]);
+        printf("\n");
+}
+
+static void csv_row(FILE * f, const char * scope, int id, const char * name,
+                const struct perf_counters * c, int64_t idle) {
+        int i;
+        fprintf(f, "%s,%d,%s", scope, id, name);
+        for (i = 0; i < NR_OPCODES; i++)
+                fprintf(f, ",%lu", (unsigned long)c->insns[i]);
+        fprintf(f, ",%lu,%lu,", (unsigned long)insns(c), (unsigned long)c->events[PERF_BUSY]);
+        if (idle >= 0)
+                fprintf(f, "%lu", (unsigned long)idle);
+        for (i = PERF_DISPATCH; i < NR_PERF_EVENTS; i++)
+                fprintf(f, ",%lu", (unsigned long)c->events[i]);
+        fprintf(f, "\n");
+}
+
+static int by_pid(const void * a, const void * b) {
+        const struct perf_proc * pa = a, * pb = b;
+        return (pa->pid > pb->pid) - (pa->pid < pb->pid);
+}
+
+/*
+! Print the counters as a table, one row per CPU and per finished process
+* @param run_slots: length of the run, a CPU is idle for the slots it was not busy
+* @param csv: file to write the rows to as CSV as well, NULL for none
+*/
+void perf_report(uint64_t run_slots, const char * csv) {
+        struct perf_counters total = { 0 };
+        struct perf_proc * procs;
+        int nr_procs = 0, i, j;
+        char label[64];
+        FILE * f = NULL;
+
+        // * Gather the finished processes from every CPU, by PID
+        for (i = 0; i < nr_slots; i++)
+                nr_procs += slots[i].nr_procs;
+        procs = malloc((nr_procs ? nr_procs : 1) * sizeof(struct perf_proc));
+        nr_procs = 0;
+        for (i = 0; i < nr_slots; i++) {
+                memcpy(&procs[nr_procs], slots[i].procs, slots[i].nr_procs * sizeof(struct perf_proc));
+                nr_procs += slots[i].nr_procs;
+        }
+        qsort(procs, nr_procs, sizeof(struct perf_proc), by_pid);
+
+        if (csv != NULL && (f = fopen(csv, "w")) == NULL)
+                printf("perf: cannot write %s\n", csv);
+        if (f != NULL) {
+                fprintf(f, "scope,id,name");
+                for (i = 0; i < NR_OPCODES; i++)
+                        fprintf(f, ",insn_%s", opcode_names[i]);
+                fprintf(f, ",insns,busy,idle");
+                for (i = PERF_DISPATCH; i < NR_PERF_EVENTS; i++)
+                        fprintf(f, ",%s", event_names[i]);
+                fprintf(f, "\n");
+        }
+
+        printf("Performance counters:\n");
+        printf("\t%-12s %8s %7s %7s", "", "insns", "busy", "idle");
+        for (i = PERF_DISPATCH; i < NR_PERF_EVENTS; i++)
+                printf(" %8s", event_names[i]);
+        printf("\n");
+        for (i = 0; i < nr_slots; i++) {
+                const struct perf_counters * c = &slots[i].c;
+                int64_t idle = run_slots - c->events[PERF_BUSY];
+                snprintf(label, sizeof(label), "cpu %d", i);
+                print_row(label, c, idle);
+                if (f != NULL)
+                        csv_row(f, "cpu", i, "", c, idle);
+                for (j = 0; j < NR_OPCODES; j++)
+                        total.insns[j] += c->insns[j];
+                for (j = 0; j < NR_PERF_EVENTS; j++)
+                        total.events[j] += c->events[j];
+        }
+        for (i = 0; i < nr_procs; i++) {
+                snprintf(label, sizeof(label), "pid %u %s", procs[i].pid, procs[i].name);
+                print_row(label, &procs[i].c, -1);
+                if (f != NULL)
+                        csv_row(f, "pid", procs[i].pid, procs[i].name, &procs[i].c, -1);
+        }
+
+        // * Instructions by opcode over every CPU
+        printf("\tby opcode:");
+        for (i = 0; i < NR_OPCODES; i++)
+                if (total.insns[i] != 0)
+                        printf(" %s %lu", opcode_names[i], (unsigned long)total.insns[i]);
+        printf("\n");
+
+        if (f != NULL)
+                fclose(f);
+        free(procs);
+}
+
+void perf_free(void) {
+        int i;
+        for (i = 0; i < nr_slots; i++)
+                free(slots[i].procs);
+        free(slots);
+        slots = NULL;
+        nr_slots = 0;
+        perf_cur = NULL;
+        cur_slot = NULL;
+}
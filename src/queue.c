@@ -26,23 +26,48 @@ int empty(struct queue_t * q) {
 }
 
 /*
-! Add a new process to queue
+! Double the ring capacity, unrolling the live entries to the front
+* @param q: queue to grow
+*/
+static void grow(struct queue_t * q) {
+        int capacity = q->capacity ? q->capacity * 2 : QUEUE_INIT_CAPACITY;
+        struct pcb_t ** proc = malloc(capacity * sizeof(struct pcb_t *));
+        if (proc == NULL) {
+                printf("queue: out of memory growing to %d slots\n", capacity);
+                exit(1);
+        }
+
+        for (int i = 0; i < q->size; i++)
+                proc[i] = q->proc[(q->head + i) & (q->capacity - 1)];
+
+        free(q->proc);
+        q->proc = proc;
+        q->head = 0;
+        q->capacity = capacity;
+}
+
+/*
+! Add a new process to the tail of queue
 * @param q: queue to add process to
 * @param proc: process to add
+* @note: the queue grows instead of dropping processes, O(1) amortized
 ! Last modified: 11/04/2025 by Nguyen Quang Long
 */
 void enqueue(struct queue_t * q, struct pcb_t * proc) {
-        // * Check queue is full
-        if (q->size == MAX_QUEUE_SIZE) 
-                return;
-        // * Put process to queue
-        q->proc[q->size++] = proc;
+        // * Make room when the ring is full
+        if (q->size == q->capacity) 
+                grow(q);
+        // * Put process to the tail
+        q->proc[(q->head + q->size) & (q->capacity - 1)] = proc;
+        q->size++;
 }
 
 /*
-! Get a process from queue
+! Get the oldest process from queue
 * @param q: queue to get process from
-* @return: process from queue
+* @return: process from queue, NULL if empty
+* @note: all processes of a queue share one priority level, so the queue
+*        is plain FIFO and this is O(1)
 ! Last modified: 11/04/2025 by Nguyen Quang Long
 */
 struct pcb_t * dequeue(struct queue_t * q) {
@@ -52,38 +77,122 @@ struct pcb_t * dequeue(struct queue_t * q) {
                 return NULL;
         }
 
-        struct pcb_t *proc = NULL;
+        // * Pop the process at the head
+        struct pcb_t *proc = q->proc[q->head];
+        q->head = (q->head + 1) & (q->capacity - 1);
+        q->size--;
+
+        // * Return the process
+        return proc;
+}
 
-        // ! Get the process with the highest priority
+/*
+! Peek a process by its position
+* @param q: queue to look into
+* @param i: position from the head, 0 is the oldest
+* @return: process at that position, NULL if out of range
+*/
+struct pcb_t * queue_at(struct queue_t * q, int i) {
+        if (q == NULL || i < 0 || i >= q->size)
+                return NULL;
+        return q->proc[(q->head + i) & (q->capacity - 1)];
+}
 
-        // * Default to the first process
-        int high_pri = q->proc[0]->prio;
-        int high_pri_idx = 0;
+/*
+! Release the ring storage of a queue
+* @param q: queue to release, left empty and reusable
+*/
+void free_queue(struct queue_t * q) {
+        free(q->proc);
+        q->proc = NULL;
+        q->head = 0;
+        q->size = 0;
+        q->capacity = 0;
+}
 
-        // * Find the process with the highest priority
-        // * and remove it from the queue
-        for (int i = 1; i < q->size; i++)
-        {
-                // * Check if the process is higher priority
-                if (q->proc[i]->prio < high_pri)
-                {       
-                        // * Update the highest priority process
-                        high_pri = q->proc[i]->prio;
-                        high_pri_idx = i;
+/*
+! Order two heap nodes
+* @return: 1 if a must be served before b
+*/
+static int pq_before(const struct pq_node * a, const struct pq_node * b) {
+        if (a->key != b->key)
+                return a->key < b->key;
+        return a->seq < b->seq;
+}
+
+/*
+! Add a process to the priority queue
+* @param q: queue to add process to
+* @param proc: process to add
+* @param key: priority of the process, smaller is served first
+*/
+void pq_enqueue(struct prio_queue_t * q, struct pcb_t * proc, uint64_t key) {
+        // * Make room when the heap is full
+        if (q->size == q->capacity) {
+                int capacity = q->capacity ? q->capacity * 2 : QUEUE_INIT_CAPACITY;
+                struct pq_node * heap = realloc(q->heap, capacity * sizeof(struct pq_node));
+                if (heap == NULL) {
+                        printf("queue: out of memory growing to %d slots\n", capacity);
+                        exit(1);
                 }
+                q->heap = heap;
+                q->capacity = capacity;
         }
 
-        // * Store the process to return
-        proc = q->proc[high_pri_idx];
+        // * Sift the new node up from the last leaf
+        struct pq_node node = { key, q->seq++, proc };
+        int i = q->size++;
+        while (i > 0) {
+                int parent = (i - 1) / 2;
+                if (!pq_before(&node, &q->heap[parent]))
+                        break;
+                q->heap[i] = q->heap[parent];
+                i = parent;
+        }
+        q->heap[i] = node;
+}
 
-        // * Remove the process from the queue
-        for (int i = high_pri_idx; i < q->size - 1; i++)
-        {
-                q->proc[i] = q->proc[i + 1];
+/*
+! Get the process with the smallest key from the priority queue
+* @param q: queue to get process from
+* @return: process from queue, NULL if empty
+*/
+struct pcb_t * pq_dequeue(struct prio_queue_t * q) {
+        if (pq_empty(q))
+                return NULL;
+
+        struct pcb_t * proc = q->heap[0].proc;
+
+        // * Sift the last leaf down from the root
+        struct pq_node last = q->heap[--q->size];
+        int i = 0;
+        for (;;) {
+                int child = 2 * i + 1;
+                if (child >= q->size)
+                        break;
+                if (child + 1 < q->size && pq_before(&q->heap[child + 1], &q->heap[child]))
+                        child++;
+                if (!pq_before(&q->heap[child], &last))
+                        break;
+                q->heap[i] = q->heap[child];
+                i = child;
         }
-        q->size--;
+        q->heap[i] = last;
 
-        // * Return the process
         return proc;
 }
 
+struct pcb_t * pq_peek(struct prio_queue_t * q) {
+        return pq_empty(q) ? NULL : q->heap[0].proc;
+}
+
+int pq_empty(struct prio_queue_t * q) {
+        return (q == NULL || q->size == 0);
+}
+
+void free_pq(struct prio_queue_t * q) {
+        free(q->heap);
+        q->heap = NULL;
+        q->size = 0;
+        q->capacity = 0;
+}
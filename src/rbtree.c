@@ -0,0 +1,251 @@
+#include "rbtree.h"
+
+/*
+! Rotate the subtree rooted at x to the left, x->right takes its place
+*/
+static void rotate_left(struct rb_root * root, struct rb_node * x) {
+        struct rb_node * y = x->right;
+
+        x->right = y->left;
+        if (y->left)
+                y->left->parent = x;
+        y->parent = x->parent;
+        if (x->parent == NULL)
+                root->node = y;
+        else if (x == x->parent->left)
+                x->parent->left = y;
+        else
+                x->parent->right = y;
+        y->left = x;
+        x->parent = y;
+}
+
+/*
+! Rotate the subtree rooted at x to the right, x->left takes its place
+*/
+static void rotate_right(struct rb_root * root, struct rb_node * x) {
+        struct rb_node * y = x->left;
+
+        x->left = y->right;
+        if (y->right)
+                y->right->parent = x;
+        y->parent = x->parent;
+        if (x->parent == NULL)
+                root->node = y;
+        else if (x == x->parent->right)
+                x->parent->right = y;
+        else
+                x->parent->left = y;
+        y->right = x;
+        x->parent = y;
+}
+
+static int is_black(const struct rb_node * node) {
+        return node == NULL || node->color == RB_BLACK;
+}
+
+/*
+! Insert a node into the tree
+* @param root: tree to insert into
+* @param node: node to link, its fields are overwritten
+* @param less: strict ordering of two nodes
+*/
+void rb_insert(struct rb_root * root, struct rb_node * node,
+               int (*less)(const struct rb_node *, const struct rb_node *)) {
+        struct rb_node ** link = &root->node;
+        struct rb_node * parent = NULL;
+        int leftmost = 1;
+
+        // * Plain BST descent, remember whether we only ever went left
+        while (*link) {
+                parent = *link;
+                if (less(node, parent)) {
+                        link = &parent->left;
+                } else {
+                        link = &parent->right;
+                        leftmost = 0;
+                }
+        }
+        node->parent = parent;
+        node->left = node->right = NULL;
+        node->color = RB_RED;
+        *link = node;
+        if (leftmost)
+                root->leftmost = node;
+        root->count++;
+
+        // * Restore the red-black properties walking up from the new node
+        while (node->parent && node->parent->color == RB_RED) {
+                struct rb_node * p = node->parent;
+                struct rb_node * g = p->parent;
+                if (p == g->left) {
+                        struct rb_node * uncle = g->right;
+                        if (!is_black(uncle)) {
+                                p->color = uncle->color = RB_BLACK;
+                                g->color = RB_RED;
+                                node = g;
+                                continue;
+                        }
+                        if (node == p->right) {
+                                node = p;
+                                rotate_left(root, node);
+                                p = node->parent;
+                        }
+                        p->color = RB_BLACK;
+                        g->color = RB_RED;
+                        rotate_right(root, g);
+                } else {
+                        struct rb_node * uncle = g->left;
+                        if (!is_black(uncle)) {
+                                p->color = uncle->color = RB_BLACK;
+                                g->color = RB_RED;
+                                node = g;
+                                continue;
+                        }
+                        if (node == p->left) {
+                                node = p;
+                                rotate_right(root, node);
+                                p = node->parent;
+                        }
+                        p->color = RB_BLACK;
+                        g->color = RB_RED;
+                        rotate_left(root, g);
+                }
+        }
+        root->node->color = RB_BLACK;
+}
+
+/*
+! Put v in the place of u under u's parent
+*/
+static void transplant(struct rb_root * root, struct rb_node * u, struct rb_node * v) {
+        if (u->parent == NULL)
+                root->node = v;
+        else if (u == u->parent->left)
+                u->parent->left = v;
+        else
+                u->parent->right = v;
+        if (v)
+                v->parent = u->parent;
+}
+
+/*
+! Fix the black height after removing a black node
+* @param x: node that took the removed node's place, may be NULL
+* @param parent: parent of x
+*/
+static void erase_fixup(struct rb_root * root, struct rb_node * x, struct rb_node * parent) {
+        while (x != root->node && is_black(x)) {
+                if (x == parent->left) {
+                        struct rb_node * w = parent->right;
+                        if (w->color == RB_RED) {
+                                w->color = RB_BLACK;
+                                parent->color = RB_RED;
+                                rotate_left(root, parent);
+                                w = parent->right;
+                        }
+                        if (is_black(w->left) && is_black(w->right)) {
+                                w->color = RB_RED;
+                                x = parent;
+                                parent = x->parent;
+                                continue;
+                        }
+                        if (is_black(w->right)) {
+                                w->left->color = RB_BLACK;
+                                w->color = RB_RED;
+                                rotate_right(root, w);
+                                w = parent->right;
+                        }
+                        w->color = parent->color;
+                        parent->color = RB_BLACK;
+                        w->right->color = RB_BLACK;
+                        rotate_left(root, parent);
+                } else {
+                        struct rb_node * w = parent->left;
+                        if (w->color == RB_RED) {
+                                w->color = RB_BLACK;
+                                parent->color = RB_RED;
+                                rotate_right(root, parent);
+                                w = parent->left;
+                        }
+                        if (is_black(w->left) && is_black(w->right)) {
+                                w->color = RB_RED;
+                                x = parent;
+                                parent = x->parent;
+                                continue;
+                        }
+                        if (is_black(w->left)) {
+                                w->right->color = RB_BLACK;
+                                w->color = RB_RED;
+                                rotate_left(root, w);
+                                w = parent->left;
+                        }
+                        w->color = parent->color;
+                        parent->color = RB_BLACK;
+                        w->left->color = RB_BLACK;
+                        rotate_right(root, parent);
+                }
+                x = root->node;
+        }
+        if (x)
+                x->color = RB_BLACK;
+}
+
+/*
+! Remove a node from the tree
+* @param root: tree holding the node
+* @param node: node to unlink
+*/
+void rb_erase(struct rb_root * root, struct rb_node * node) {
+        struct rb_node * x;
+        struct rb_node * parent;
+        int color = node->color;
+
+        if (root->leftmost == node)
+                root->leftmost = rb_next(node);
+        root->count--;
+
+        if (node->left == NULL) {
+                x = node->right;
+                parent = node->parent;
+                transplant(root, node, x);
+        } else if (node->right == NULL) {
+                x = node->left;
+                parent = node->parent;
+                transplant(root, node, x);
+        } else {
+                // * Two children: the successor takes the node's place
+                struct rb_node * y = node->right;
+                while (y->left)
+                        y = y->left;
+                color = y->color;
+                x = y->right;
+                if (y->parent == node) {
+                        parent = y;
+                } else {
+                        parent = y->parent;
+                        transplant(root, y, x);
+                        y->right = node->right;
+                        y->right->parent = y;
+                }
+                transplant(root, node, y);
+                y->left = node->left;
+                y->left->parent = y;
+                y->color = node->color;
+        }
+
+        if (color == RB_BLACK)
+                erase_fixup(root, x, parent);
+}
+
+struct rb_node * rb_next(const struct rb_node * node) {
+        if (node->right) {
+                node = node->right;
+                while (node->left)
+                        node = node->left;
+                return (struct rb_node *)node;
+        }
+        while (node->parent && node == node->parent->right)
+                node = node->parent;
+        return node->parent;
+}
@@ -0,0 +1,150 @@
+#include "replay.h"
+#include "timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Log format: the header "OSRR", a version byte and the number of CPUs as
+ * a varint, then one record per CPU step: varint(cpu << 1 | dispatched),
+ * followed by varint(pid) if the step dispatched a process. A step of a
+ * small machine that did not dispatch takes a single byte.
+ */
+#define RR_MAGIC	"OSRR"
+#define RR_VERSION	1
+
+static int mode = RR_OFF;
+static FILE * log_file;
+static int cpus;
+
+static pthread_mutex_t turn_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t turn_cond = PTHREAD_COND_INITIALIZER;
+
+/* Next logged step while replaying, cpu is -1 past the end of the log */
+static struct {
+	int cpu;
+	uint32_t pid;
+} next;
+
+static uint64_t * stepped;	/* Slot each CPU last stepped in, plus one */
+static char * stopped;
+
+static void put_varint(uint64_t v) {
+	while (v >= 0x80) {
+		fputc((int)(v & 0x7f) | 0x80, log_file);
+		v >>= 7;
+	}
+	fputc((int)v, log_file);
+}
+
+static int get_varint(uint64_t * v) {
+	int shift = 0, c;
+	*v = 0;
+	while ((c = fgetc(log_file)) != EOF) {
+		*v |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return 0;
+		shift += 7;
+	}
+	return -1;
+}
+
+static void read_next(void) {
+	uint64_t rec, pid = 0;
+	if (get_varint(&rec) != 0 || ((rec & 1) && get_varint(&pid) != 0)) {
+		next.cpu = -1;
+		return;
+	}
+	next.cpu = (int)(rec >> 1);
+	next.pid = (uint32_t)pid;
+}
+
+static void diverged(int cpu, const char * what) {
+	printf("Replay diverged at time slot %lu, CPU %d: %s\n",
+		current_time(), cpu, what);
+	exit(1);
+}
+
+void rr_open(const char * path, int rr_mode, int num_cpus) {
+	char magic[4];
+	uint64_t n;
+
+	mode = rr_mode;
+	cpus = num_cpus;
+	if (mode == RR_OFF)
+		return;
+	log_file = fopen(path, mode == RR_RECORD ? "wb" : "rb");
+	if (log_file == NULL) {
+		printf("Cannot open replay log %s\n", path);
+		exit(1);
+	}
+	stepped = calloc(num_cpus, sizeof(uint64_t));
+	stopped = calloc(num_cpus, sizeof(char));
+	if (mode == RR_RECORD) {
+		fwrite(RR_MAGIC, 1, 4, log_file);
+		fputc(RR_VERSION, log_file);
+		put_varint(num_cpus);
+		return;
+	}
+	if (fread(magic, 1, 4, log_file) != 4 || memcmp(magic, RR_MAGIC, 4)
+	    || fgetc(log_file) != RR_VERSION) {
+		printf("%s is not a replay log\n", path);
+		exit(1);
+	}
+	if (get_varint(&n) != 0 || n != (uint64_t)num_cpus) {
+		printf("Replay log %s was recorded with %lu CPUs, not %d\n",
+			path, (unsigned long)n, num_cpus);
+		exit(1);
+	}
+	read_next();
+}
+
+void rr_begin(int cpu) {
+	if (mode == RR_OFF)
+		return;
+	pthread_mutex_lock(&turn_lock);
+	while (mode == RR_REPLAY && next.cpu != cpu) {
+		/* The logged CPU can not come if it is done with this slot */
+		if (next.cpu < 0)
+			diverged(cpu, "the log has ended");
+		if (next.cpu >= cpus || stopped[next.cpu] ||
+		    stepped[next.cpu] == current_time() + 1)
+			diverged(cpu, "the logged CPU can not run now");
+		pthread_cond_wait(&turn_cond, &turn_lock);
+	}
+}
+
+void rr_end(int cpu, uint32_t pid, int stop) {
+	char what[80];
+
+	if (mode == RR_OFF)
+		return;
+	stepped[cpu] = current_time() + 1;
+	stopped[cpu] = stop;
+	if (mode == RR_RECORD) {
+		put_varint((uint64_t)cpu << 1 | (pid != 0));
+		if (pid != 0)
+			put_varint(pid);
+	}else{
+		if (next.pid != pid) {
+			snprintf(what, sizeof(what),
+				"dispatched process %u, the log says %u",
+				pid, next.pid);
+			diverged(cpu, what);
+		}
+		read_next();
+		pthread_cond_broadcast(&turn_cond);
+	}
+	pthread_mutex_unlock(&turn_lock);
+}
+
+void rr_close(void) {
+	if (mode == RR_OFF)
+		return;
+	if (mode == RR_REPLAY && next.cpu >= 0)
+		printf("Replay log has steps left over\n");
+	fclose(log_file);
+	free(stepped);
+	free(stopped);
+}
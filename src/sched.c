@@ -11,156 +11,717 @@
 */
 #include "queue.h"
 #include "sched.h"
+#include "sched_policy.h"
+#include "bitops.h"
 #include <pthread.h>
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#ifdef MLQ_SCHED
 static struct queue_t ready_queue;
 static struct queue_t run_queue;
+#else
+/* Single-queue mode: binary heaps keyed by priority, FIFO among equals */
+static struct prio_queue_t ready_queue;
+static struct prio_queue_t run_queue;
+#endif
 static pthread_mutex_t queue_lock;
 
 static struct queue_t running_list;
 #ifdef MLQ_SCHED
-static struct queue_t mlq_ready_queue[MAX_PRIO];
+/*
+ * One MLQ run queue. In SCHED_RQ_GLOBAL mode every CPU shares rqs[0];
+ * in SCHED_RQ_PERCPU mode each CPU owns rqs[cpu] and only touches a
+ * sibling's queue when it runs dry and steals.
+ */
+struct mlq_rq {
+	pthread_mutex_t lock;
+	struct queue_t ready[MAX_PRIO];
+	/* Bit i is set iff ready[i] may hold a process. Lower index means
+	 * higher priority, so the lowest set bit is the next level to serve */
+	uint64_t bitmap[BITMAP_WORDS(MAX_PRIO)];
+	int nr_ready;	/* Read unlocked as a load hint by siblings */
+	/* Slot policy state: the level being served and how many of its
+	 * slot[curr_prio] dispatches it has used in this round */
+	int curr_prio;
+	int curr_slot;
+	unsigned long dispatched[MAX_PRIO];	/* Dispatch count per level */
+	/* Aging state: the epoch counts dispatches from this run queue, a
+	 * process waits (epoch - its enqueue epoch) dispatches */
+	uint64_t epoch;
+	int age_prio;				/* Level aged last */
+	unsigned long max_wait[MAX_PRIO];	/* Longest wait per own level */
+};
+
+static struct mlq_rq * rqs = NULL;
+static int nr_rqs = 0;
+static int rq_mode = SCHED_RQ_GLOBAL;
+static int rq_cpus = 1;
 static int slot[MAX_PRIO];
+static int aging = 0;	/* Dispatches waited before a promotion, 0 is off */
+static int quota = 0;	/* Serve the levels by slot[] budget, 0 is strict */
 #endif
 
-int queue_empty(void) {
+/* Accounting of the processes that ran to completion */
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long nr_exited;
+static unsigned long total_turnaround;
+static unsigned long total_wait;
+static unsigned long nr_deadline;	/* Finished processes that had a deadline */
+static unsigned long nr_missed;
+static unsigned long max_lateness;
+
+static void (*kill_hook)(int killed) = NULL;
+
+/*
+! Enable MLQ aging
+ * @param dispatches: a process that waited this many dispatches at the
+ *                    head of its level moves up one level, 0 disables
+*/
+void sched_set_aging(int dispatches) {
 #ifdef MLQ_SCHED
-	unsigned long prio;
-	for (prio = 0; prio < MAX_PRIO; prio++)
-		if(!empty(&mlq_ready_queue[prio])) 
-			return -1;
+	aging = dispatches > 0 ? dispatches : 0;
 #endif
-	return (empty(&ready_queue) && empty(&run_queue));
 }
 
-void init_scheduler(void) {
+/*
+! Select how MLQ levels share the CPUs
+ * @param on: 1 gives each level slot[prio] dispatches per round,
+ *            0 always serves the highest non-empty level
+*/
+void sched_set_quota(int on) {
 #ifdef MLQ_SCHED
-    int i ;
+	quota = on != 0;
+#endif
+}
 
-	for (i = 0; i < MAX_PRIO; i ++) {
-		mlq_ready_queue[i].size = 0;
-		slot[i] = MAX_PRIO - i; 
-	}
+/*
+! Select the run queue layout, must be called before init_scheduler()
+ * @param mode: SCHED_RQ_GLOBAL or SCHED_RQ_PERCPU
+ * @param num_cpus: number of CPUs that will call get_cpu_proc()
+*/
+void sched_set_rq_mode(int mode, int num_cpus) {
+#ifdef MLQ_SCHED
+	rq_mode = mode;
+	rq_cpus = num_cpus > 0 ? num_cpus : 1;
 #endif
-	ready_queue.size = 0;
-	run_queue.size = 0;
-	pthread_mutex_init(&queue_lock, NULL);
 }
 
 #ifdef MLQ_SCHED
-/* 
+static int mlq_empty(void) {
+	int i, w;
+	for (i = 0; i < nr_rqs; i++)
+		for (w = 0; w < BITMAP_WORDS(MAX_PRIO); w++)
+			if (rqs[i].bitmap[w])
+				return -1;
+	return (empty(&ready_queue) && empty(&run_queue));
+}
+
+static void mlq_init(void) {
+	int i, n;
+
+	for (i = 0; i < MAX_PRIO; i ++)
+		slot[i] = MAX_PRIO - i;
+
+	n = (rq_mode == SCHED_RQ_PERCPU) ? rq_cpus : 1;
+	if (n != nr_rqs) {
+		for (i = 0; i < nr_rqs; i++) {
+			int prio;
+			for (prio = 0; prio < MAX_PRIO; prio++)
+				free_queue(&rqs[i].ready[prio]);
+		}
+		free(rqs);
+		rqs = calloc(n, sizeof(struct mlq_rq));
+		nr_rqs = n;
+	}
+	for (i = 0; i < nr_rqs; i++) {
+		int prio, w;
+		for (prio = 0; prio < MAX_PRIO; prio++)
+			rqs[i].ready[prio].size = 0;
+		for (w = 0; w < BITMAP_WORDS(MAX_PRIO); w++)
+			rqs[i].bitmap[w] = 0;
+		rqs[i].nr_ready = 0;
+		rqs[i].curr_prio = 0;
+		rqs[i].curr_slot = 0;
+		for (prio = 0; prio < MAX_PRIO; prio++) {
+			rqs[i].dispatched[prio] = 0;
+			rqs[i].max_wait[prio] = 0;
+		}
+		rqs[i].epoch = 0;
+		rqs[i].age_prio = 0;
+		pthread_mutex_init(&rqs[i].lock, NULL);
+	}
+}
+
+/*
+! Helper to enqueue into an MLQ level and mark it non-empty in the bitmap
+ * @note: caller must hold rq->lock
+*/
+static void mlq_enqueue(struct mlq_rq * rq, struct pcb_t * proc) {
+	proc->mlq_ready_queue = rq->ready;
+	proc->mlq_boost = 0;
+	proc->mlq_ready_epoch = rq->epoch;
+	proc->mlq_level_epoch = rq->epoch;
+	enqueue(&rq->ready[proc->prio], proc);
+	bitmap_set(rq->bitmap, proc->prio);
+	__atomic_store_n(&rq->nr_ready, rq->nr_ready + 1, __ATOMIC_RELAXED);
+}
+
+/*
+! Helper to dispatch the oldest process of a non-empty MLQ level
+ * @note: caller must hold rq->lock
+*/
+static struct pcb_t * mlq_take(struct mlq_rq * rq, int prio) {
+	struct pcb_t * proc = dequeue(&rq->ready[prio]);
+	unsigned long wait;
+	if (empty(&rq->ready[prio]))
+		bitmap_clear(rq->bitmap, prio);
+	__atomic_store_n(&rq->nr_ready, rq->nr_ready - 1, __ATOMIC_RELAXED);
+
+	/* Aging only lasts while waiting, the process runs and is accounted
+	 * at its own level */
+	proc->prio += proc->mlq_boost;
+	proc->mlq_boost = 0;
+	rq->dispatched[proc->prio]++;
+	wait = rq->epoch - proc->mlq_ready_epoch;
+	if (wait > rq->max_wait[proc->prio])
+		rq->max_wait[proc->prio] = wait;
+	rq->epoch++;
+	return proc;
+}
+
+/*
+! Helper to age one level of a run queue per dispatch
+ * Levels are FIFO and a process joins a level with the current epoch, so
+ * the head of a level is its longest waiter and is the only one to check.
+ * The non-empty levels are visited round robin, which keeps the cost O(1)
+ * per dispatch whatever the queue lengths.
+ * @note: caller must hold rq->lock
+*/
+static void mlq_age(struct mlq_rq * rq) {
+	struct pcb_t * proc;
+	int prio = bitmap_next(rq->bitmap, MAX_PRIO, rq->age_prio + 1);
+	if (prio == MAX_PRIO)
+		prio = bitmap_first(rq->bitmap, MAX_PRIO);
+	if (prio == MAX_PRIO)
+		return;
+	rq->age_prio = prio;
+	if (prio == 0)
+		return;
+
+	proc = queue_at(&rq->ready[prio], 0);
+	if (rq->epoch - proc->mlq_level_epoch < (uint64_t)aging)
+		return;
+
+	/* Move it to the tail of the level above, it has to wait there again
+	 * before the next promotion */
+	dequeue(&rq->ready[prio]);
+	if (empty(&rq->ready[prio]))
+		bitmap_clear(rq->bitmap, prio);
+	proc->prio = prio - 1;
+	proc->mlq_boost++;
+	proc->mlq_level_epoch = rq->epoch;
+	enqueue(&rq->ready[prio - 1], proc);
+	bitmap_set(rq->bitmap, prio - 1);
+}
+
+/*
+! Helper to pick the next process of a run queue
+ * Without a quota this is the highest non-empty level. Under the slot
+ * policy levels are served from high to low priority, each one for at
+ * most slot[prio] dispatches before moving on to the next non-empty
+ * level, then the round starts over from the top. Every step is a
+ * bitmap lookup, so the cost does not depend on the number of levels.
+ * @note: caller must hold rq->lock
+*/
+static struct pcb_t * mlq_dequeue(struct mlq_rq * rq) {
+	int prio;
+
+	if (aging > 0)
+		mlq_age(rq);
+	if (!quota) {
+		prio = bitmap_first(rq->bitmap, MAX_PRIO);
+		return prio == MAX_PRIO ? NULL : mlq_take(rq, prio);
+	}
+	prio = rq->curr_prio;
+
+	if (!bitmap_test(rq->bitmap, prio) || rq->curr_slot >= slot[prio]) {
+		/* Level drained or out of budget, move on to the next one */
+		prio = bitmap_next(rq->bitmap, MAX_PRIO, prio + 1);
+		if (prio == MAX_PRIO)
+			prio = bitmap_first(rq->bitmap, MAX_PRIO);
+		if (prio == MAX_PRIO)
+			return NULL;
+		rq->curr_prio = prio;
+		rq->curr_slot = 0;
+	}
+	rq->curr_slot++;
+	return mlq_take(rq, prio);
+}
+
+/*
+! Helper to map a CPU to the run queue it dispatches from
+*/
+static struct mlq_rq * cpu_rq(int cpu) {
+	if (rq_mode != SCHED_RQ_PERCPU || cpu < 0)
+		return &rqs[0];
+	return &rqs[cpu % nr_rqs];
+}
+
+/*
+! Helper to steal work for an idle CPU from its busiest sibling
+ * @param cpu: the idle CPU
+ * @return: the highest priority process of the busiest sibling, or NULL
+*/
+static struct pcb_t * mlq_steal(int cpu) {
+	struct mlq_rq * self = cpu_rq(cpu);
+	struct pcb_t * proc = NULL;
+
+	while (proc == NULL) {
+		struct mlq_rq * victim = NULL;
+		int busiest = 0;
+		int i;
+		/* Pick the victim on unlocked hints, only lock the one we raid */
+		for (i = 0; i < nr_rqs; i++) {
+			int load = __atomic_load_n(&rqs[i].nr_ready, __ATOMIC_RELAXED);
+			if (&rqs[i] != self && load > busiest) {
+				busiest = load;
+				victim = &rqs[i];
+			}
+		}
+		if (victim == NULL)
+			return NULL;
+
+		/* Take the victim's most urgent process, leaving its own slot
+		 * round untouched */
+		pthread_mutex_lock(&victim->lock);
+		int prio = bitmap_first(victim->bitmap, MAX_PRIO);
+		if (prio < MAX_PRIO)
+			proc = mlq_take(victim, prio);
+		pthread_mutex_unlock(&victim->lock);
+	}
+	return proc;
+}
+
+/*
  *  Stateful design for routine calling
  *  based on the priority and our MLQ policy
  *  We implement stateful here using transition technique
  *  State representation   prio = 0 .. MAX_PRIO, curr_slot = 0..(MAX_PRIO - prio)
 ! Last modified: 13/04/2025 by Nguyen Quang Long
  */
-struct pcb_t * get_mlq_proc(void) {
+static struct pcb_t * get_mlq_proc(int cpu) {
+	struct mlq_rq * rq = cpu_rq(cpu);
 	struct pcb_t * proc = NULL;
-	pthread_mutex_lock(&queue_lock);
-	for (int i = 0; i < MAX_PRIO; i++)
-	{
-		if (!empty(&mlq_ready_queue[i]))
-		{
-			proc = dequeue(&mlq_ready_queue[i]);
-			break;
-		}
-	}
-	pthread_mutex_unlock(&queue_lock);
-	return proc;	
+	pthread_mutex_lock(&rq->lock);
+	proc = mlq_dequeue(rq);
+	pthread_mutex_unlock(&rq->lock);
+
+	if (proc == NULL && rq_mode == SCHED_RQ_PERCPU)
+		proc = mlq_steal(cpu);
+	return proc;
 }
 
 /*
 ! Helper function to put a process back to run queue
+ * @param cpu: CPU the process was running on, it is re-queued locally
  * @param proc: process to put back
 ! Last modified: 11/04/2025 by Nguyen Quang Long
 */
-void put_mlq_proc(struct pcb_t * proc) {
-	pthread_mutex_lock(&queue_lock);
-	enqueue(&mlq_ready_queue[proc->prio], proc);
-	pthread_mutex_unlock(&queue_lock);
+static void put_mlq_proc(int cpu, struct pcb_t * proc) {
+	struct mlq_rq * rq = cpu_rq(cpu);
+	pthread_mutex_lock(&rq->lock);
+	mlq_enqueue(rq, proc);
+	pthread_mutex_unlock(&rq->lock);
 }
 
 /*
 ! Helper function to add a new process to ready queue
- * @param proc: process to add
+ * @param proc: process to add, placed on the least loaded run queue
 ! Last modified: 11/04/2025 by Nguyen Quang Long
 */
-void add_mlq_proc(struct pcb_t * proc) {
-	pthread_mutex_lock(&queue_lock);
-	enqueue(&mlq_ready_queue[proc->prio], proc);
-	pthread_mutex_unlock(&queue_lock);	
+static void add_mlq_proc(struct pcb_t * proc) {
+	struct mlq_rq * rq = &rqs[0];
+	int i;
+	for (i = 1; i < nr_rqs; i++)
+		if (__atomic_load_n(&rqs[i].nr_ready, __ATOMIC_RELAXED)
+		    < __atomic_load_n(&rq->nr_ready, __ATOMIC_RELAXED))
+			rq = &rqs[i];
+
+	pthread_mutex_lock(&rq->lock);
+	mlq_enqueue(rq, proc);
+	pthread_mutex_unlock(&rq->lock);
 }
 
-/*
-! Get a process from ready queue
- * @return: process from queue
-! Last modified: 11/04/2025 by Nguyen Quang Long
-*/
-struct pcb_t * get_proc(void) {
-	return get_mlq_proc();
+/* Round robin within a level: the process gives up the CPU after a quantum */
+static int mlq_tick(int cpu, struct pcb_t * proc, int time_left) {
+	return time_left <= 0;
+}
+
+static int mlq_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	int killed = 0;
+	int i, prio;
+	for (i = 0; i < nr_rqs; i++) {
+		struct mlq_rq * rq = &rqs[i];
+		pthread_mutex_lock(&rq->lock);
+		for (prio = 0; prio < MAX_PRIO; prio++) {
+			struct queue_t * q = &rq->ready[prio];
+			int n;
+			if (!bitmap_test(rq->bitmap, prio))
+				continue;
+			/* Rotate the level once, keeping survivors in order */
+			for (n = q->size; n > 0; n--) {
+				struct pcb_t * proc = dequeue(q);
+				if (match(proc, arg)) {
+					__atomic_store_n(&rq->nr_ready,
+						rq->nr_ready - 1, __ATOMIC_RELAXED);
+					killed++;
+				} else {
+					enqueue(q, proc);
+				}
+			}
+			if (empty(q))
+				bitmap_clear(rq->bitmap, prio);
+		}
+		pthread_mutex_unlock(&rq->lock);
+	}
+	return killed;
 }
 
 /*
-! Put a process back to run queue
- * @param proc: process to put back
-! Last modified: 11/04/2025 by Nguyen Quang Long
+! Number of dispatches served from one MLQ level since init_scheduler()
+ * @param prio: the level
+ * @return: dispatch count summed over every run queue
 */
-void put_proc(struct pcb_t * proc) {
-	proc->ready_queue = &ready_queue;
-	proc->mlq_ready_queue = mlq_ready_queue;
-	proc->running_list = & running_list;
-
-	return put_mlq_proc(proc);
+unsigned long sched_dispatch_count(int prio) {
+	unsigned long count = 0;
+	int i;
+	if (prio < 0 || prio >= MAX_PRIO)
+		return 0;
+	for (i = 0; i < nr_rqs; i++) {
+		pthread_mutex_lock(&rqs[i].lock);
+		count += rqs[i].dispatched[prio];
+		pthread_mutex_unlock(&rqs[i].lock);
+	}
+	return count;
 }
 
 /*
-! Add a new process to ready queue
- * @param proc: process to add
-! Last modified: 11/04/2025 by Nguyen Quang Long
+! Longest wait of a process of one MLQ level since init_scheduler()
+ * @param prio: the level the process belongs to, before any aging
+ * @return: number of dispatches from its run queue it waited for
 */
-void add_proc(struct pcb_t * proc) {
-	proc->ready_queue = &ready_queue;
-	proc->mlq_ready_queue = mlq_ready_queue;
-	proc->running_list = & running_list;
+unsigned long sched_max_wait(int prio) {
+	unsigned long wait = 0;
+	int i;
+	if (prio < 0 || prio >= MAX_PRIO)
+		return 0;
+	for (i = 0; i < nr_rqs; i++) {
+		pthread_mutex_lock(&rqs[i].lock);
+		if (rqs[i].max_wait[prio] > wait)
+			wait = rqs[i].max_wait[prio];
+		pthread_mutex_unlock(&rqs[i].lock);
+	}
+	return wait;
+}
 
-	return add_mlq_proc(proc);
+static void mlq_report(void) {
+	int prio;
+	printf("MLQ dispatches per level:\n");
+	for (prio = 0; prio < MAX_PRIO; prio++) {
+		unsigned long count = sched_dispatch_count(prio);
+		if (count > 0)
+			printf("\tprio %3d (slot %3d): %lu, max wait %lu dispatches\n",
+				prio, slot[prio], count, sched_max_wait(prio));
+	}
 }
+
+static const struct sched_policy mlq_policy = {
+	.name = "mlq",
+	.init = mlq_init,
+	.enqueue = add_mlq_proc,
+	.pick_next = get_mlq_proc,
+	.requeue = put_mlq_proc,
+	.tick = mlq_tick,
+	.kill = mlq_kill,
+	.empty = mlq_empty,
+	.report = mlq_report,
+};
+#define DEFAULT_POLICY mlq_policy
 #else
-struct pcb_t * get_proc(void) {
+static int prio_empty(void) {
+	return (pq_empty(&ready_queue) && pq_empty(&run_queue));
+}
+
+static void prio_init(void) {
+	ready_queue.size = 0;
+	run_queue.size = 0;
+}
+
+static struct pcb_t * prio_pick_next(int cpu) {
 	struct pcb_t * proc = NULL;
-	/*TODO: get a process from [ready_queue].
-	 * Remember to use lock to protect the queue.
-	 * */
 	pthread_mutex_lock(&queue_lock);
-	proc = dequeue(&ready_queue);
+	/* Once every ready process had its turn, the preempted ones in
+	 * run_queue become the ready set of the next round */
+	if (pq_empty(&ready_queue)) {
+		struct prio_queue_t tmp = ready_queue;
+		ready_queue = run_queue;
+		run_queue = tmp;
+	}
+	proc = pq_dequeue(&ready_queue);
 	pthread_mutex_unlock(&queue_lock);
 	return proc;
 }
 
-void put_proc(struct pcb_t * proc) {
-	proc->ready_queue = &ready_queue;
-	proc->running_list = & running_list;
+static void prio_requeue(int cpu, struct pcb_t * proc) {
+	pthread_mutex_lock(&queue_lock);
+	pq_enqueue(&run_queue, proc, proc->priority);
+	pthread_mutex_unlock(&queue_lock);
+}
 
-	/* TODO: put running proc to running_list */
+static void prio_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&queue_lock);
+	pq_enqueue(&ready_queue, proc, proc->priority);
+	pthread_mutex_unlock(&queue_lock);	
+}
+
+static int prio_tick(int cpu, struct pcb_t * proc, int time_left) {
+	return time_left <= 0;
+}
 
+static int prio_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	struct prio_queue_t * queues[] = { &ready_queue, &run_queue };
+	int killed = 0;
+	int i, n;
 	pthread_mutex_lock(&queue_lock);
-	enqueue(&run_queue, proc);
+	for (i = 0; i < 2; i++) {
+		/* Drain in priority order, survivors re-enter in that same order */
+		struct prio_queue_t kept = { 0 };
+		for (n = queues[i]->size; n > 0; n--) {
+			struct pcb_t * proc = pq_dequeue(queues[i]);
+			if (match(proc, arg))
+				killed++;
+			else
+				pq_enqueue(&kept, proc, proc->priority);
+		}
+		free_pq(queues[i]);
+		*queues[i] = kept;
+	}
 	pthread_mutex_unlock(&queue_lock);
+	return killed;
 }
 
-void add_proc(struct pcb_t * proc) {
+unsigned long sched_dispatch_count(int prio) {
+	return 0;
+}
+
+unsigned long sched_max_wait(int prio) {
+	return 0;
+}
+
+static const struct sched_policy prio_policy = {
+	.name = "prio",
+	.init = prio_init,
+	.enqueue = prio_enqueue,
+	.pick_next = prio_pick_next,
+	.requeue = prio_requeue,
+	.tick = prio_tick,
+	.kill = prio_kill,
+	.empty = prio_empty,
+};
+#define DEFAULT_POLICY prio_policy
+#endif
+
+/* Policies selectable with sched_set_policy(), the first one is the default */
+static const struct sched_policy * const policies[] = {
+	&DEFAULT_POLICY,
+	&fifo_policy,
+	&sjf_policy,
+	&srtf_policy,
+	&cfs_policy,
+	&edf_policy,
+	&stride_policy,
+	&lottery_policy,
+};
+static const struct sched_policy * policy = &DEFAULT_POLICY;
+
+/*
+! Select the scheduling policy, must be called before init_scheduler()
+ * @param name: one of "mlq", "fifo", "sjf", "srtf", "cfs", "edf",
+ *              "stride", "lottery"
+ * @return: 0 on success, -1 if no policy has that name
+*/
+int sched_set_policy(const char * name) {
+	int i;
+	for (i = 0; i < (int)(sizeof(policies) / sizeof(policies[0])); i++) {
+		if (!strcmp(policies[i]->name, name)) {
+			policy = policies[i];
+			return 0;
+		}
+	}
+	return -1;
+}
+
+const char * sched_policy_name(void) {
+	return policy->name;
+}
+
+int queue_empty(void) {
+	return policy->empty();
+}
+
+void init_scheduler(void) {
+	policy->init();
+#ifdef MLQ_SCHED
+	ready_queue.size = 0;
+	run_queue.size = 0;
+#endif
+	pthread_mutex_init(&queue_lock, NULL);
+
+	pthread_mutex_lock(&stats_lock);
+	nr_exited = 0;
+	total_turnaround = 0;
+	total_wait = 0;
+	nr_deadline = 0;
+	nr_missed = 0;
+	max_lateness = 0;
+	pthread_mutex_unlock(&stats_lock);
+}
+
+/*
+! Print the scheduler statistics, called once the simulation is over
+*/
+void finish_scheduler(void) {
+	pthread_mutex_lock(&stats_lock);
+	printf("Scheduler policy: %s\n", policy->name);
+	if (nr_exited > 0)
+		printf("\t%lu processes finished, mean turnaround: %.2f, mean waiting: %.2f\n",
+			nr_exited, (double)total_turnaround / nr_exited,
+			(double)total_wait / nr_exited);
+	if (nr_deadline > 0)
+		printf("\tdeadlines missed: %lu/%lu, max lateness: %lu\n",
+			nr_missed, nr_deadline, max_lateness);
+	pthread_mutex_unlock(&stats_lock);
+	if (policy->report != NULL)
+		policy->report();
+}
+
+/*
+! Account a process that ran to completion, before it is freed
+ * @param proc: the finished process
+ * @param now: current time slot, compared to proc->deadline if it has one
+*/
+void sched_exit(struct pcb_t * proc, uint64_t now) {
+	unsigned long turnaround = now > proc->arrival_time ?
+		now - proc->arrival_time : 0;
+	/* Every instruction takes one slot, the rest was spent waiting */
+	unsigned long wait = turnaround > proc->burst_time ?
+		turnaround - proc->burst_time : 0;
+
+	pthread_mutex_lock(&stats_lock);
+	nr_exited++;
+	total_turnaround += turnaround;
+	total_wait += wait;
+	if (proc->deadline) {
+		nr_deadline++;
+		if (now > proc->deadline) {
+			nr_missed++;
+			if (now - proc->deadline > max_lateness)
+				max_lateness = now - proc->deadline;
+		}
+	}
+	pthread_mutex_unlock(&stats_lock);
+}
+
+/*
+! Account one instruction executed by a running process
+ * @param cpu: CPU running the process
+ * @param proc: the running process
+ * @param time_left: slots left in its quantum
+ * @return: 1 if the process must give the CPU back now
+*/
+int sched_tick(int cpu, struct pcb_t * proc, int time_left) {
+	if (proc->remaining_time > 0)
+		proc->remaining_time--;
+	return policy->tick(cpu, proc, time_left);
+}
+
+/*
+! Remove matching processes from every ready queue
+ * @param match: called on each ready process, returns 1 to take it out;
+ *               a removed process is owned by the caller from then on
+ * @param arg: passed through to match
+ * @return: number of processes removed
+*/
+int kill_procs(int (*match)(struct pcb_t *, void *), void * arg) {
+	int killed = policy->kill(match, arg);
+	if (killed > 0 && kill_hook != NULL)
+		kill_hook(killed);
+	return killed;
+}
+
+/*
+! Register a callback for the processes killed off the ready queues
+ * @param hook: called with the number removed by each kill_procs(),
+ *              NULL for none
+*/
+void sched_set_kill_hook(void (*hook)(int killed)) {
+	kill_hook = hook;
+}
+
+/*
+! Get a process from the run queue of a CPU
+ * @param cpu: CPU asking for work
+ * @return: process from queue
+*/
+struct pcb_t * get_cpu_proc(int cpu) {
+	return policy->pick_next(cpu);
+}
+
+/*
+! Put a process back to the run queue of a CPU
+ * @param cpu: CPU the process was running on
+ * @param proc: process to put back
+*/
+void put_cpu_proc(int cpu, struct pcb_t * proc) {
+#ifdef MLQ_SCHED
 	proc->ready_queue = &ready_queue;
+#endif
 	proc->running_list = & running_list;
 
-	/* TODO: put running proc to running_list */
+	return policy->requeue(cpu, proc);
+}
 
-	pthread_mutex_lock(&queue_lock);
-	enqueue(&ready_queue, proc);
-	pthread_mutex_unlock(&queue_lock);	
+/*
+! Get a process from ready queue
+ * @return: process from queue
+! Last modified: 11/04/2025 by Nguyen Quang Long
+*/
+struct pcb_t * get_proc(void) {
+	return get_cpu_proc(0);
+}
+
+/*
+! Put a process back to run queue
+ * @param proc: process to put back
+! Last modified: 11/04/2025 by Nguyen Quang Long
+*/
+void put_proc(struct pcb_t * proc) {
+	return put_cpu_proc(0, proc);
 }
+
+/*
+! Add a new process to ready queue
+ * @param proc: process to add
+! Last modified: 11/04/2025 by Nguyen Quang Long
+*/
+void add_proc(struct pcb_t * proc) {
+#ifdef MLQ_SCHED
+	proc->ready_queue = &ready_queue;
 #endif
+	proc->running_list = & running_list;
 
+	return policy->enqueue(proc);
+}
 
@@ -0,0 +1,139 @@
+/*
+ * Completely fair policy. Each process accumulates a virtual runtime, the
+ * time it spent on a CPU scaled down by its weight, and the runnable ones
+ * sit in a red-black tree ordered by vruntime. Dispatch always picks the
+ * leftmost one, so over time every process gets a CPU share proportional
+ * to its weight instead of the strict precedence of MLQ.
+ *
+ * Weights follow the Linux nice table: the 140 priority levels are folded
+ * onto nice -20..19, one nice step is about 1.25x the CPU share.
+ */
+#include "sched.h"
+#include "sched_policy.h"
+#include <pthread.h>
+
+#define CFS_NICE_0_LOAD	1024
+#define CFS_NR_NICE	40
+
+static const int nice_to_weight[CFS_NR_NICE] = {
+	88761, 71755, 56483, 46273, 36291,
+	29154, 23254, 18705, 14949, 11916,
+	 9548,  7620,  6100,  4904,  3906,
+	 3121,  2501,  1991,  1586,  1277,
+	 1024,   820,   655,   526,   423,
+	  335,   272,   215,   172,   137,
+	  110,    87,    70,    56,    45,
+	   36,    29,    23,    18,    15,
+};
+
+static pthread_mutex_t cfs_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rb_root cfs_tree;
+/* Floor for the vruntime of newcomers, only ever moves forward */
+static uint64_t min_vruntime;
+/* vruntime charged for one slot of CPU time at each priority level */
+static uint64_t vdelta[MAX_PRIO];
+
+static uint32_t cfs_prio(struct pcb_t * proc) {
+#ifdef MLQ_SCHED
+	return proc->prio < MAX_PRIO ? proc->prio : MAX_PRIO - 1;
+#else
+	return proc->priority < MAX_PRIO ? proc->priority : MAX_PRIO - 1;
+#endif
+}
+
+static int vruntime_less(const struct rb_node * a, const struct rb_node * b) {
+	return rb_entry(a, struct pcb_t, run_node)->vruntime
+		< rb_entry(b, struct pcb_t, run_node)->vruntime;
+}
+
+static void cfs_init(void) {
+	int prio;
+	for (prio = 0; prio < MAX_PRIO; prio++) {
+		int weight = nice_to_weight[prio * CFS_NR_NICE / MAX_PRIO];
+		/* Fixed point, 1 slot at nice 0 is worth 1024 */
+		vdelta[prio] = ((uint64_t)CFS_NICE_0_LOAD << 10) / weight;
+	}
+	pthread_mutex_lock(&cfs_lock);
+	cfs_tree.node = NULL;
+	cfs_tree.leftmost = NULL;
+	cfs_tree.count = 0;
+	min_vruntime = 0;
+	pthread_mutex_unlock(&cfs_lock);
+}
+
+/* A newcomer starts level with the slowest runnable process so it can not
+ * monopolize the CPUs to catch up with processes that ran for long */
+static void cfs_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&cfs_lock);
+	proc->vruntime = min_vruntime;
+	rb_insert(&cfs_tree, &proc->run_node, vruntime_less);
+	pthread_mutex_unlock(&cfs_lock);
+}
+
+static void cfs_requeue(int cpu, struct pcb_t * proc) {
+	pthread_mutex_lock(&cfs_lock);
+	rb_insert(&cfs_tree, &proc->run_node, vruntime_less);
+	pthread_mutex_unlock(&cfs_lock);
+}
+
+static struct pcb_t * cfs_pick_next(int cpu) {
+	struct rb_node * node;
+	struct pcb_t * proc = NULL;
+	pthread_mutex_lock(&cfs_lock);
+	node = rb_first(&cfs_tree);
+	if (node != NULL) {
+		rb_erase(&cfs_tree, node);
+		proc = rb_entry(node, struct pcb_t, run_node);
+		if (proc->vruntime > min_vruntime)
+			min_vruntime = proc->vruntime;
+	}
+	pthread_mutex_unlock(&cfs_lock);
+	return proc;
+}
+
+/* Charge the slot to the running process, which is off the tree so no
+ * lock is needed. At the end of the quantum it goes back to the tree and
+ * the leftmost process is picked, which may well be itself again */
+static int cfs_tick(int cpu, struct pcb_t * proc, int time_left) {
+	proc->vruntime += vdelta[cfs_prio(proc)];
+	return time_left <= 0;
+}
+
+/* match() may free the process, so each one leaves the tree first and
+ * the survivors are moved to a new tree in vruntime order */
+static int cfs_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	struct rb_root kept = { NULL, NULL, 0 };
+	struct rb_node * node;
+	int killed = 0;
+	pthread_mutex_lock(&cfs_lock);
+	while ((node = rb_first(&cfs_tree)) != NULL) {
+		struct pcb_t * proc = rb_entry(node, struct pcb_t, run_node);
+		rb_erase(&cfs_tree, node);
+		if (match(proc, arg))
+			killed++;
+		else
+			rb_insert(&kept, &proc->run_node, vruntime_less);
+	}
+	cfs_tree = kept;
+	pthread_mutex_unlock(&cfs_lock);
+	return killed;
+}
+
+static int cfs_empty(void) {
+	int ret;
+	pthread_mutex_lock(&cfs_lock);
+	ret = (cfs_tree.count == 0);
+	pthread_mutex_unlock(&cfs_lock);
+	return ret;
+}
+
+const struct sched_policy cfs_policy = {
+	.name = "cfs",
+	.init = cfs_init,
+	.enqueue = cfs_enqueue,
+	.pick_next = cfs_pick_next,
+	.requeue = cfs_requeue,
+	.tick = cfs_tick,
+	.kill = cfs_kill,
+	.empty = cfs_empty,
+};
@@ -0,0 +1,201 @@
+/*
+ * Single-queue batch policies. Every CPU dispatches from one shared ready
+ * set protected by batch_lock:
+ *   fifo  arrival order, a process keeps the CPU until it finishes
+ *   sjf   shortest burst_time first, non-preemptive
+ *   srtf  shortest remaining_time first, the running process is preempted
+ *         as soon as a shorter one is ready
+ *   edf   earliest deadline first, preempts like srtf. Processes without
+ *         a deadline only run when no deadline-tagged one is ready
+ */
+#include "queue.h"
+#include "sched_policy.h"
+#include <pthread.h>
+
+static pthread_mutex_t batch_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct queue_t fifo_queue;
+/* Shared by sjf, srtf and edf, only one policy is active at a time */
+static struct prio_queue_t short_queue;
+
+static int batch_empty(void) {
+	int ret;
+	pthread_mutex_lock(&batch_lock);
+	ret = empty(&fifo_queue) && pq_empty(&short_queue);
+	pthread_mutex_unlock(&batch_lock);
+	return ret;
+}
+
+static void batch_init(void) {
+	pthread_mutex_lock(&batch_lock);
+	free_queue(&fifo_queue);
+	free_pq(&short_queue);
+	pthread_mutex_unlock(&batch_lock);
+}
+
+/* Non-preemptive policies ignore the quantum */
+static int batch_tick(int cpu, struct pcb_t * proc, int time_left) {
+	return 0;
+}
+
+static void fifo_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&batch_lock);
+	enqueue(&fifo_queue, proc);
+	pthread_mutex_unlock(&batch_lock);
+}
+
+static void fifo_requeue(int cpu, struct pcb_t * proc) {
+	fifo_enqueue(proc);
+}
+
+static struct pcb_t * fifo_pick_next(int cpu) {
+	struct pcb_t * proc;
+	pthread_mutex_lock(&batch_lock);
+	proc = dequeue(&fifo_queue);
+	pthread_mutex_unlock(&batch_lock);
+	return proc;
+}
+
+static int fifo_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	int killed = 0;
+	int n;
+	pthread_mutex_lock(&batch_lock);
+	/* Rotate the queue once, keeping survivors in order */
+	for (n = fifo_queue.size; n > 0; n--) {
+		struct pcb_t * proc = dequeue(&fifo_queue);
+		if (match(proc, arg))
+			killed++;
+		else
+			enqueue(&fifo_queue, proc);
+	}
+	pthread_mutex_unlock(&batch_lock);
+	return killed;
+}
+
+static void sjf_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&batch_lock);
+	pq_enqueue(&short_queue, proc, proc->burst_time);
+	pthread_mutex_unlock(&batch_lock);
+}
+
+static void sjf_requeue(int cpu, struct pcb_t * proc) {
+	sjf_enqueue(proc);
+}
+
+static void srtf_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&batch_lock);
+	pq_enqueue(&short_queue, proc, proc->remaining_time);
+	pthread_mutex_unlock(&batch_lock);
+}
+
+static void srtf_requeue(int cpu, struct pcb_t * proc) {
+	srtf_enqueue(proc);
+}
+
+static struct pcb_t * short_pick_next(int cpu) {
+	struct pcb_t * proc;
+	pthread_mutex_lock(&batch_lock);
+	proc = pq_dequeue(&short_queue);
+	pthread_mutex_unlock(&batch_lock);
+	return proc;
+}
+
+/* Preempt only when a ready process would finish sooner */
+static int srtf_tick(int cpu, struct pcb_t * proc, int time_left) {
+	struct pcb_t * next;
+	int preempt;
+	pthread_mutex_lock(&batch_lock);
+	next = pq_peek(&short_queue);
+	preempt = next != NULL && next->remaining_time < proc->remaining_time;
+	pthread_mutex_unlock(&batch_lock);
+	return preempt;
+}
+
+/* No deadline sorts after every real one */
+static uint64_t edf_key(struct pcb_t * proc) {
+	return proc->deadline ? proc->deadline : UINT64_MAX;
+}
+
+static void edf_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&batch_lock);
+	pq_enqueue(&short_queue, proc, edf_key(proc));
+	pthread_mutex_unlock(&batch_lock);
+}
+
+static void edf_requeue(int cpu, struct pcb_t * proc) {
+	edf_enqueue(proc);
+}
+
+/* Preempt only when a ready process is due sooner */
+static int edf_tick(int cpu, struct pcb_t * proc, int time_left) {
+	struct pcb_t * next;
+	int preempt;
+	pthread_mutex_lock(&batch_lock);
+	next = pq_peek(&short_queue);
+	preempt = next != NULL && edf_key(next) < edf_key(proc);
+	pthread_mutex_unlock(&batch_lock);
+	return preempt;
+}
+
+static int short_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	struct prio_queue_t kept = { 0 };
+	int killed = 0;
+	int n;
+	pthread_mutex_lock(&batch_lock);
+	/* Survivors keep their keys, ties keep their relative order */
+	for (n = short_queue.size; n > 0; n--) {
+		uint64_t key = short_queue.heap[0].key;
+		struct pcb_t * proc = pq_dequeue(&short_queue);
+		if (match(proc, arg))
+			killed++;
+		else
+			pq_enqueue(&kept, proc, key);
+	}
+	free_pq(&short_queue);
+	short_queue = kept;
+	pthread_mutex_unlock(&batch_lock);
+	return killed;
+}
+
+const struct sched_policy fifo_policy = {
+	.name = "fifo",
+	.init = batch_init,
+	.enqueue = fifo_enqueue,
+	.pick_next = fifo_pick_next,
+	.requeue = fifo_requeue,
+	.tick = batch_tick,
+	.kill = fifo_kill,
+	.empty = batch_empty,
+};
+
+const struct sched_policy sjf_policy = {
+	.name = "sjf",
+	.init = batch_init,
+	.enqueue = sjf_enqueue,
+	.pick_next = short_pick_next,
+	.requeue = sjf_requeue,
+	.tick = batch_tick,
+	.kill = short_kill,
+	.empty = batch_empty,
+};
+
+const struct sched_policy srtf_policy = {
+	.name = "srtf",
+	.init = batch_init,
+	.enqueue = srtf_enqueue,
+	.pick_next = short_pick_next,
+	.requeue = srtf_requeue,
+	.tick = srtf_tick,
+	.kill = short_kill,
+	.empty = batch_empty,
+};
+
+const struct sched_policy edf_policy = {
+	.name = "edf",
+	.init = batch_init,
+	.enqueue = edf_enqueue,
+	.pick_next = short_pick_next,
+	.requeue = edf_requeue,
+	.tick = edf_tick,
+	.kill = short_kill,
+	.empty = batch_empty,
+};
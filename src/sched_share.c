@@ -0,0 +1,270 @@
+/*
+ * Proportional-share policies. Every process holds tickets, either set
+ * with the settickets syscall or derived from prio the same way as the
+ * MLQ slot quota (MAX_PRIO - prio), and receives CPU slots in proportion
+ * to them.
+ *   stride   deterministic: each process advances a pass value by
+ *            STRIDE1 / tickets per slot it runs, the lowest pass runs next
+ *   lottery  randomized: each dispatch draws a ticket, the per-process
+ *            counts live in a Fenwick tree so the draw is O(log n)
+ */
+#include "queue.h"
+#include "sched.h"
+#include "sched_policy.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+#define STRIDE1		(1 << 20)
+#define LOTTERY_SEED	0x9e3779b97f4a7c15ULL
+
+static pthread_mutex_t share_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+! Tickets held by a process
+*/
+static uint32_t proc_tickets(struct pcb_t * proc) {
+	uint32_t prio;
+	if (proc->tickets > 0)
+		return proc->tickets;
+#ifdef MLQ_SCHED
+	prio = proc->prio;
+#else
+	prio = proc->priority;
+#endif
+	return prio < MAX_PRIO ? MAX_PRIO - prio : 1;
+}
+
+/* Stride ------------------------------------------------------------ */
+
+static struct prio_queue_t stride_queue;
+/* Pass of the last dispatched process, newcomers start from here */
+static uint64_t global_pass;
+
+static void stride_init(void) {
+	pthread_mutex_lock(&share_lock);
+	free_pq(&stride_queue);
+	global_pass = 0;
+	pthread_mutex_unlock(&share_lock);
+}
+
+static void stride_enqueue(struct pcb_t * proc) {
+	pthread_mutex_lock(&share_lock);
+	proc->pass = global_pass;
+	pq_enqueue(&stride_queue, proc, proc->pass);
+	pthread_mutex_unlock(&share_lock);
+}
+
+static void stride_requeue(int cpu, struct pcb_t * proc) {
+	pthread_mutex_lock(&share_lock);
+	pq_enqueue(&stride_queue, proc, proc->pass);
+	pthread_mutex_unlock(&share_lock);
+}
+
+static struct pcb_t * stride_pick_next(int cpu) {
+	struct pcb_t * proc;
+	pthread_mutex_lock(&share_lock);
+	proc = pq_dequeue(&stride_queue);
+	if (proc != NULL && proc->pass > global_pass)
+		global_pass = proc->pass;
+	pthread_mutex_unlock(&share_lock);
+	return proc;
+}
+
+/* The running process is off the queue, charging it needs no lock */
+static int stride_tick(int cpu, struct pcb_t * proc, int time_left) {
+	proc->pass += STRIDE1 / proc_tickets(proc);
+	return time_left <= 0;
+}
+
+static int stride_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	struct prio_queue_t kept = { 0 };
+	int killed = 0;
+	int n;
+	pthread_mutex_lock(&share_lock);
+	for (n = stride_queue.size; n > 0; n--) {
+		struct pcb_t * proc = pq_dequeue(&stride_queue);
+		if (match(proc, arg))
+			killed++;
+		else
+			pq_enqueue(&kept, proc, proc->pass);
+	}
+	free_pq(&stride_queue);
+	stride_queue = kept;
+	pthread_mutex_unlock(&share_lock);
+	return killed;
+}
+
+static int stride_empty(void) {
+	int ret;
+	pthread_mutex_lock(&share_lock);
+	ret = pq_empty(&stride_queue);
+	pthread_mutex_unlock(&share_lock);
+	return ret;
+}
+
+/* Lottery ----------------------------------------------------------- */
+
+/* Ready processes sit in numbered slots, lot_tree[i] (1-based) is the
+ * Fenwick sum of the tickets of slots i - (i & -i) + 1 .. i */
+static struct pcb_t ** lot_proc;	/* Slot -> process, NULL if free */
+static uint32_t * lot_weight;		/* Tickets counted for each slot */
+static uint64_t * lot_tree;
+static int * lot_free;			/* Stack of free slots */
+static int lot_nfree;
+static int lot_cap;			/* Power of two */
+static int lot_used;			/* Slots ever handed out */
+static int lot_count;
+static uint64_t lot_total;
+static uint64_t lot_rand;
+
+static void fenwick_add(int slot, int64_t delta) {
+	int i;
+	for (i = slot + 1; i <= lot_cap; i += i & -i)
+		lot_tree[i] += delta;
+}
+
+/*
+! Find the slot holding the [r]-th ticket, 0 <= r < lot_total
+*/
+static int fenwick_find(uint64_t r) {
+	int pos = 0;
+	int step;
+	for (step = lot_cap; step > 0; step >>= 1) {
+		if (pos + step <= lot_cap && lot_tree[pos + step] <= r) {
+			pos += step;
+			r -= lot_tree[pos];
+		}
+	}
+	return pos;
+}
+
+static void lottery_grow(void) {
+	int cap = lot_cap ? lot_cap * 2 : QUEUE_INIT_CAPACITY;
+	int i;
+	lot_proc = realloc(lot_proc, cap * sizeof(*lot_proc));
+	lot_weight = realloc(lot_weight, cap * sizeof(*lot_weight));
+	lot_free = realloc(lot_free, cap * sizeof(*lot_free));
+	free(lot_tree);
+	lot_tree = calloc(cap + 1, sizeof(*lot_tree));
+	if (lot_proc == NULL || lot_weight == NULL || lot_free == NULL || lot_tree == NULL) {
+		printf("lottery: out of memory growing to %d slots\n", cap);
+		exit(1);
+	}
+	lot_cap = cap;
+	/* Rebuild the tree, O(n log n) once per doubling */
+	for (i = 0; i < lot_used; i++)
+		if (lot_proc[i] != NULL)
+			fenwick_add(i, lot_weight[i]);
+}
+
+static void lottery_init(void) {
+	int i;
+	pthread_mutex_lock(&share_lock);
+	for (i = 0; lot_tree != NULL && i <= lot_cap; i++)
+		lot_tree[i] = 0;
+	lot_nfree = 0;
+	lot_used = 0;
+	lot_count = 0;
+	lot_total = 0;
+	lot_rand = LOTTERY_SEED;
+	pthread_mutex_unlock(&share_lock);
+}
+
+static void lottery_enqueue(struct pcb_t * proc) {
+	int slot;
+	pthread_mutex_lock(&share_lock);
+	if (lot_nfree > 0) {
+		slot = lot_free[--lot_nfree];
+	} else {
+		if (lot_used == lot_cap)
+			lottery_grow();
+		slot = lot_used++;
+	}
+	lot_proc[slot] = proc;
+	lot_weight[slot] = proc_tickets(proc);
+	fenwick_add(slot, lot_weight[slot]);
+	lot_total += lot_weight[slot];
+	lot_count++;
+	pthread_mutex_unlock(&share_lock);
+}
+
+static void lottery_requeue(int cpu, struct pcb_t * proc) {
+	lottery_enqueue(proc);
+}
+
+/*
+! Take a process out of its slot
+ * @note: caller must hold share_lock
+*/
+static struct pcb_t * lottery_take(int slot) {
+	struct pcb_t * proc = lot_proc[slot];
+	fenwick_add(slot, -(int64_t)lot_weight[slot]);
+	lot_total -= lot_weight[slot];
+	lot_proc[slot] = NULL;
+	lot_free[lot_nfree++] = slot;
+	lot_count--;
+	return proc;
+}
+
+static struct pcb_t * lottery_pick_next(int cpu) {
+	struct pcb_t * proc = NULL;
+	pthread_mutex_lock(&share_lock);
+	if (lot_count > 0) {
+		/* xorshift64*, reproducible from run to run */
+		lot_rand ^= lot_rand >> 12;
+		lot_rand ^= lot_rand << 25;
+		lot_rand ^= lot_rand >> 27;
+		proc = lottery_take(fenwick_find(
+			(lot_rand * 0x2545f4914f6cdd1dULL) % lot_total));
+	}
+	pthread_mutex_unlock(&share_lock);
+	return proc;
+}
+
+static int lottery_tick(int cpu, struct pcb_t * proc, int time_left) {
+	return time_left <= 0;
+}
+
+static int lottery_kill(int (*match)(struct pcb_t *, void *), void * arg) {
+	int killed = 0;
+	int i;
+	pthread_mutex_lock(&share_lock);
+	for (i = 0; i < lot_used; i++) {
+		if (lot_proc[i] != NULL && match(lot_proc[i], arg)) {
+			lottery_take(i);
+			killed++;
+		}
+	}
+	pthread_mutex_unlock(&share_lock);
+	return killed;
+}
+
+static int lottery_empty(void) {
+	int ret;
+	pthread_mutex_lock(&share_lock);
+	ret = (lot_count == 0);
+	pthread_mutex_unlock(&share_lock);
+	return ret;
+}
+
+const struct sched_policy stride_policy = {
+	.name = "stride",
+	.init = stride_init,
+	.enqueue = stride_enqueue,
+	.pick_next = stride_pick_next,
+	.requeue = stride_requeue,
+	.tick = stride_tick,
+	.kill = stride_kill,
+	.empty = stride_empty,
+};
+
+const struct sched_policy lottery_policy = {
+	.name = "lottery",
+	.init = lottery_init,
+	.enqueue = lottery_enqueue,
+	.pick_next = lottery_pick_next,
+	.requeue = lottery_requeue,
+	.tick = lottery_tick,
+	.kill = lottery_kill,
+	.empty = lottery_empty,
+};
@@ -23,8 +23,13 @@
  #include "syscall.h"
  #include "stdio.h"
  #include "libmem.h"
+ #include "mm.h"
  #include "queue.h"
+ #include "sched.h"
+ #include "loader.h"
+ #include "perf.h"
  #include <string.h>
+ #include <stdlib.h>
  #include <ctype.h>
  
  // Function to check if 'substr' is contained in 'path', ignoring case.
@@ -52,6 +57,30 @@
      return 0;  // Substring not found.
  }
  
+ // Callback for kill_procs: terminate ready processes whose path contains 'arg'.
+ static int kill_match(struct pcb_t *proc, void *arg) {
+     const char *proc_name = arg;
+ 
+     if (path_contains(proc->path, proc_name) != 1)
+         return 0;
+ #ifdef MLQ_SCHED
+     // Only the MLQ policy keeps one ready queue per priority level
+     if (strcmp(sched_policy_name(), "mlq") == 0)
+         printf("Killing process PID=%d, name=\"%s\" from mlq_ready_queue[%d]\n", proc->pid, proc->path, proc->prio);
+     else
+ #endif
+         printf("Killing process PID=%d, name=\"%s\" from %s ready queue\n", proc->pid, proc->path, sched_policy_name());
+     perf_exit(proc);
+     release_code(proc->code);
+ #ifdef MM_PAGING
+     free_pcb_memph(proc);
+     free_mm(proc->mm);
+ #endif
+     free(proc->page_table);
+     free(proc);
+     return 1;
+ }
+ 
  int __sys_killall(struct pcb_t *caller, struct sc_regs* regs)
  {
      char proc_name[100];
@@ -84,44 +113,19 @@
       *        name in var proc_name
       */
      if (caller->running_list != NULL) {
-         int j = 0;
-         while (j < caller->running_list->size) {
-             struct pcb_t *proc = caller->running_list->proc[j];
+         struct queue_t *q = caller->running_list;
+         // Rotate the list once, dropping matches and keeping the others in order
+         for (int n = q->size; n > 0; n--) {
+             struct pcb_t *proc = dequeue(q);
              if (path_contains(proc->path, proc_name) == 1) {
                  printf("Killing process PID=%d, name=\"%s\" from running_list\n", proc->pid, proc->path);
-                 // Giả lập kill: loại bỏ process khỏi danh sách bằng cách shift các phần tử phía sau lên
-                 for (int k = j; k < caller->running_list->size - 1; k++) {
-                     caller->running_list->proc[k] = caller->running_list->proc[k + 1];
-                 }
-                 caller->running_list->size--;
-                 // Không tăng j vì phần tử mới chuyển lên vị trí j cần được kiểm tra lại
              } else {
-                 j++;
+                 enqueue(q, proc);
              }
          }
      }
  
- #ifdef MLQ_SCHED
-     if (caller->mlq_ready_queue != NULL) {
-         for (int p = 0; p < MAX_PRIO; p++) {
-             struct queue_t *q = &caller->mlq_ready_queue[p];
-             int j = 0;
-             while (j < q->size) {
-                 struct pcb_t *proc = q->proc[j];
-                 if (path_contains(proc->path, proc_name) == 1) {
-                     printf("Killing process PID=%d, name=\"%s\" from mlq_ready_queue[%d]\n", proc->pid, proc->path, p);
-                     for (int k = j; k < q->size - 1; k++) {
-                         q->proc[k] = q->proc[k + 1];
-                     }
-                     q->size--;
-                     // Không tăng j vì cần kiểm tra lại vị trí j mới
-                 } else {
-                     j++;
-                 }
-             }
-         }
-     }
- #endif
+     kill_procs(kill_match, proc_name);
  
      return 0; 
  }
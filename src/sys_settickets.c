@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2025 pdnguyen of HCMC University of Technology VNU-HCM
+ */
+
+/* Sierra release
+ * Source Code License Grant: The authors hereby grant to Licensee
+ * personal permission to use and modify the Licensed Source Code
+ * for the sole purpose of studying while attending the course CO2018.
+ */
+
+#include "syscall.h"
+#include "common.h"
+
+/* Largest ticket count, keeps the stride of every process at least 1 */
+#define MAX_TICKETS	(1 << 20)
+
+/*
+ * settickets(n): set the CPU share of the caller under the stride and
+ * lottery policies. n = 0 goes back to the default derived from prio.
+ * Takes effect the next time the caller is put back to the ready queue.
+ */
+int __sys_settickets(struct pcb_t *caller, struct sc_regs *regs)
+{
+   if (regs->a1 > MAX_TICKETS) {
+       printf("[PID %d] settickets: %u tickets exceeds %d\n",
+              caller->pid, regs->a1, MAX_TICKETS);
+       return -1;
+   }
+   caller->tickets = regs->a1;
+   printf("[PID %d] tickets set to %u\n", caller->pid, regs->a1);
+
+   return 0;
+}
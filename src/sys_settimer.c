@@ -1,5 +1,7 @@
 #include "syscall.h"
 #include "common.h"
+#include "sched.h"
+#include "timer.h"
 #include "stdio.h"
 /*
 * Assignment - Operating System
@@ -13,22 +15,26 @@
      Đỗ Quang Long      2311896     Scheduler 
 */
 
-int check[100] = {0}; // Kiểm tra xem PID đã được đặt báo thức chưa
+/* The alarm of a sleeping process went off, make it runnable again */
+static void alarm_ring(struct tw_timer *alarm) {
+    struct pcb_t *proc = tw_entry(alarm, struct pcb_t, alarm);
+    printf("[PID %d] 🔔 Alarm ringing at tick %lu!\n", proc->pid, current_time());
+    proc->sleeping = 0;
+    add_proc(proc);
+}
+
+/*
+ * settimer(ticks): the caller sleeps off the run queue for [ticks] slots,
+ * the CPU drops it at the end of the slot and the timer wheel puts it
+ * back in the slot the alarm expires in. 0 ticks does nothing.
+ */
 int __sys_settimer(struct pcb_t *caller, struct sc_regs *regs) {
-    static uint32_t alarm_time[100] = {0};  // Mỗi PID đặt riêng
-    uint32_t pid = caller->pid;
-    int tick = 0;
-    if (regs->a1 > 0 && check[pid] == 0) {
-        alarm_time[pid] = tick + regs->a1;
-        printf("[PID %d] Alarm set at tick %d (current tick: %d)\n",
-               pid, alarm_time[pid], tick);
-        for (int i = regs->a1; i > 0; i--) {
-            printf("[PID %d] Alarm pending... (%d ticks remaining)\n",
-                   pid, i);
-            
-        }
-        check[pid] = 1; // Đánh dấu PID đã được đặt báo thức
-        printf("[PID %d] 🔔 Alarm ringing at tick %d!\n", pid, regs->a1);
-    }
+    uint64_t now = current_time();
+    if (regs->a1 == 0)
+        return 0;
+    caller->sleeping = 1;
+    timer_arm(&caller->alarm, now + regs->a1, alarm_ring);
+    printf("[PID %d] Alarm set at tick %lu (current tick: %lu)\n",
+           caller->pid, now + regs->a1, now);
     return 0;
 }
@@ -10,6 +10,7 @@
 
 #include "syscall.h"
 #include "common.h"
+#include "perf.h"
 
 #define __SYSCALL(nr, sym) extern int __##sym(struct pcb_t*,struct sc_regs*);
 #include "syscalltbl.lst"
@@ -36,8 +37,9 @@ int __sys_ni_syscall(struct pcb_t *caller, struct sc_regs *regs)
 }
 
 #define __SYSCALL(nr, sym) case nr: return __##sym(caller,regs);
-int syscall(struct pcb_t *caller, uint32_t nr, struct sc_regs* regs)
+int do_syscall(struct pcb_t *caller, uint32_t nr, struct sc_regs* regs)
 {
+	perf_count(caller, PERF_SYSCALL);
 	switch (nr) {
 	#include "syscalltbl.lst"
 	default: return __sys_ni_syscall(caller, regs);
@@ -1,9 +1,35 @@
-
 #include "timer.h"
+#include "twheel.h"
 #include <stdio.h>
 #include <stdlib.h>
-
-static pthread_t _timer;
+#include <limits.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
+/*
+ * Every attached thread (CPU or loader) calls next_slot() when it is done
+ * with the current time slot. The slots are separated by a sense-reversing
+ * barrier: the last thread to arrive advances the time and flips the
+ * global sense, which releases everybody else with one futex broadcast.
+ * A tick therefore costs one atomic add per thread and a single wake-up,
+ * instead of a lock/signal handshake between a timer thread and each
+ * participant.
+ *
+ * In tickless mode an idle participant arrives through next_idle_slot()
+ * with the first slot it has work in. When a slot ends with everybody
+ * idle, the time jumps straight to the earliest of those slots instead of
+ * stepping (and printing) every empty slot in between.
+ *
+ * Timers armed with timer_arm() sit on a hierarchical timing wheel that
+ * follows the time. A slot is closed with everybody else parked, so the
+ * wheel fires its callbacks there without racing any participant, and
+ * whatever they wake up is in place before the new slot starts.
+ */
 
 struct timer_id_container_t {
 	struct timer_id_t id;
@@ -15,81 +41,165 @@ static struct timer_id_container_t * dev_list = NULL;
 static uint64_t _time;
 
 static int timer_started = 0;
-static int timer_stop = 0;
 
+static int tickless = 0;
 
-static void * timer_routine(void * args) {
-	while (!timer_stop) {
-		printf("Time slot %3lu\n", current_time());
-		int fsh = 0;
-		int event = 0;
-		/* Wait for all devices have done the job in current
-		 * time slot */
-		struct timer_id_container_t * temp;
-		for (temp = dev_list; temp != NULL; temp = temp->next) {
-			pthread_mutex_lock(&temp->id.event_lock);
-			while (!temp->id.done && !temp->id.fsh) {
-				pthread_cond_wait(
-					&temp->id.event_cond,
-					&temp->id.event_lock
-				);
-			}
-			if (temp->id.fsh) {
-				fsh++;
-			}
-			event++;
-			pthread_mutex_unlock(&temp->id.event_lock);
-		}
+static struct twheel wheel;
+static pthread_mutex_t wheel_lock = PTHREAD_MUTEX_INITIALIZER;
 
-		/* Increase the time slot */
-		_time++;
-		
-		/* Let devices continue their job */
-		for (temp = dev_list; temp != NULL; temp = temp->next) {
-			pthread_mutex_lock(&temp->id.timer_lock);
-			temp->id.done = 0;
-			pthread_cond_signal(&temp->id.timer_cond);
-			pthread_mutex_unlock(&temp->id.timer_lock);
-		}
-		if (fsh == event) {
-			break;
-		}
+/* Earliest slot any participant has work in, 0 once someone was busy */
+static uint64_t barrier_wake = UINT64_MAX;
+
+/* Barrier state: participants in the high half, arrivals in this slot in
+ * the low half, so that arriving and detaching are a single atomic op */
+#define BARRIER_ONE_PARTICIPANT	(1ULL << 32)
+#define BARRIER_ARRIVED(state)	((uint32_t)(state))
+#define BARRIER_PARTICIPANTS(state)	((uint32_t)((state) >> 32))
+
+static uint64_t barrier_state;
+static int barrier_sense;	/* Futex word, flips once per slot */
+
+static void sense_wait(int old) {
+	while (__atomic_load_n(&barrier_sense, __ATOMIC_ACQUIRE) == old) {
+#ifdef __linux__
+		syscall(SYS_futex, &barrier_sense, FUTEX_WAIT_PRIVATE, old,
+			NULL, NULL, 0);
+#else
+		sched_yield();
+#endif
 	}
-	pthread_exit(args);
 }
 
-void next_slot(struct timer_id_t * timer_id) {
+static void sense_flip(int sense) {
+	__atomic_store_n(&barrier_sense, sense, __ATOMIC_RELEASE);
+#ifdef __linux__
+	syscall(SYS_futex, &barrier_sense, FUTEX_WAKE_PRIVATE, INT_MAX,
+		NULL, NULL, 0);
+#endif
+}
+
+/*
+ * Close the current slot, called by whoever completed the barrier. Every
+ * other participant is parked in sense_wait(), so nothing else touches
+ * the barrier until the sense flips.
+ */
+static void end_slot(int sense, uint32_t participants) {
+	uint64_t next = current_time() + 1;
+
+	__atomic_store_n(&barrier_state,
+		(uint64_t)participants * BARRIER_ONE_PARTICIPANT, __ATOMIC_RELAXED);
+	if (tickless) {
+		uint64_t wake = __atomic_exchange_n(&barrier_wake, UINT64_MAX,
+			__ATOMIC_RELAXED);
+		uint64_t expiry = tw_next(&wheel);
+		if (expiry < wake)
+			wake = expiry;
+		/* Nobody waits on a known slot: keep ticking */
+		if (wake > next && wake != UINT64_MAX)
+			next = wake;
+	}
+	__atomic_store_n(&_time, next, __ATOMIC_RELAXED);
+	if (participants > 0)
+		printf("Time slot %3lu\n", current_time());
+	tw_advance(&wheel, next);
+	sense_flip(sense);
+}
+
+static void arrive(struct timer_id_t * timer_id) {
+	int sense = !timer_id->sense;
+	uint64_t state;
+
 	/* Tell to timer that we have done our job in current slot */
-	pthread_mutex_lock(&timer_id->event_lock);
-	timer_id->done = 1;
-	pthread_cond_signal(&timer_id->event_cond);
-	pthread_mutex_unlock(&timer_id->event_lock);
+	timer_id->sense = sense;
+	state = __atomic_add_fetch(&barrier_state, 1, __ATOMIC_ACQ_REL);
+	if (BARRIER_ARRIVED(state) == BARRIER_PARTICIPANTS(state)) {
+		end_slot(sense, BARRIER_PARTICIPANTS(state));
+		return;
+	}
 
 	/* Wait for going to next slot */
-	pthread_mutex_lock(&timer_id->timer_lock);
-	while (timer_id->done) {
-		pthread_cond_wait(
-			&timer_id->timer_cond,
-			&timer_id->timer_lock
-		);
+	sense_wait(!sense);
+}
+
+void next_slot(struct timer_id_t * timer_id) {
+	if (tickless && __atomic_load_n(&barrier_wake, __ATOMIC_RELAXED) != 0)
+		__atomic_store_n(&barrier_wake, 0, __ATOMIC_RELAXED);
+	arrive(timer_id);
+}
+
+void next_idle_slot(struct timer_id_t * timer_id, uint64_t wake) {
+	if (tickless) {
+		uint64_t cur = __atomic_load_n(&barrier_wake, __ATOMIC_RELAXED);
+		while (wake < cur && !__atomic_compare_exchange_n(&barrier_wake,
+				&cur, wake, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			;
 	}
-	pthread_mutex_unlock(&timer_id->timer_lock);
+	arrive(timer_id);
 }
 
 uint64_t current_time() {
-	return _time;
+	return __atomic_load_n(&_time, __ATOMIC_RELAXED);
+}
+
+/* Move the time to slot [t] with nobody attached, for the single threaded
+ * engine. Every slot on the way is printed as if it had been stepped,
+ * except in tickless mode */
+void advance_time(uint64_t t) {
+	uint64_t now = current_time();
+	if (tickless && t > now + 1)
+		now = t - 1;
+	while (now < t) {
+		__atomic_store_n(&_time, ++now, __ATOMIC_RELAXED);
+		printf("Time slot %3lu\n", now);
+		tw_advance(&wheel, now);
+	}
+}
+
+/* Arm [t] to call [fn] in slot [expires], from any participant */
+void timer_arm(struct tw_timer * t, uint64_t expires,
+		void (*fn)(struct tw_timer *)) {
+	pthread_mutex_lock(&wheel_lock);
+	tw_arm(&wheel, t, expires, fn);
+	pthread_mutex_unlock(&wheel_lock);
+}
+
+int timer_cancel(struct tw_timer * t) {
+	int armed;
+	pthread_mutex_lock(&wheel_lock);
+	armed = tw_cancel(&wheel, t);
+	pthread_mutex_unlock(&wheel_lock);
+	return armed;
+}
+
+uint64_t timer_next(void) {
+	uint64_t next;
+	pthread_mutex_lock(&wheel_lock);
+	next = tw_next(&wheel);
+	pthread_mutex_unlock(&wheel_lock);
+	return next;
+}
+
+int timer_pending(void) {
+	return __atomic_load_n(&wheel.pending, __ATOMIC_RELAXED);
+}
+
+void set_tickless(int on) {
+	tickless = on;
 }
 
 void start_timer() {
 	timer_started = 1;
-	pthread_create(&_timer, NULL, timer_routine, NULL);
+	tw_init(&wheel, current_time());
+	printf("Time slot %3lu\n", current_time());
 }
 
+/* Leave the barrier for good. If everybody else already arrived, the
+ * slot is waiting on us only and we close it on the way out */
 void detach_event(struct timer_id_t * event) {
-	pthread_mutex_lock(&event->event_lock);
-	event->fsh = 1;
-	pthread_cond_signal(&event->event_cond);
-	pthread_mutex_unlock(&event->event_lock);
+	uint64_t state = __atomic_sub_fetch(&barrier_state,
+		BARRIER_ONE_PARTICIPANT, __ATOMIC_ACQ_REL);
+	if (BARRIER_ARRIVED(state) == BARRIER_PARTICIPANTS(state))
+		end_slot(!event->sense, BARRIER_PARTICIPANTS(state));
 }
 
 struct timer_id_t * attach_event() {
@@ -100,12 +210,8 @@ struct timer_id_t * attach_event() {
 			(struct timer_id_container_t*)malloc(
 				sizeof(struct timer_id_container_t)		
 			);
-		container->id.done = 0;
-		container->id.fsh = 0;
-		pthread_cond_init(&container->id.event_cond, NULL);
-		pthread_mutex_init(&container->id.event_lock, NULL);
-		pthread_cond_init(&container->id.timer_cond, NULL);
-		pthread_mutex_init(&container->id.timer_lock, NULL);
+		container->id.sense = 0;
+		barrier_state += BARRIER_ONE_PARTICIPANT;
 		if (dev_list == NULL) {
 			dev_list = container;
 			dev_list->next = NULL;
@@ -118,19 +224,9 @@ struct timer_id_t * attach_event() {
 }
 
 void stop_timer() {
-	timer_stop = 1;
-	pthread_join(_timer, NULL);
 	while (dev_list != NULL) {
 		struct timer_id_container_t * temp = dev_list;
 		dev_list = dev_list->next;
-		pthread_cond_destroy(&temp->id.event_cond);
-		pthread_mutex_destroy(&temp->id.event_lock);
-		pthread_cond_destroy(&temp->id.timer_cond);
-		pthread_mutex_destroy(&temp->id.timer_lock);
 		free(temp);
 	}
 }
-
-
-
-
@@ -0,0 +1,154 @@
+/*
+ * Per-CPU software TLB tlb.c
+ */
+
+#include "tlb.h"
+#include "mm.h"
+#include <stdlib.h>
+#include <string.h>
+
+static struct tlb *tlbs;
+static int nr_tlbs;
+
+/* TLB of the CPU this thread runs a slot for, NULL outside of a CPU */
+static __thread struct tlb *cur;
+
+#define TLB_SET(pgn) ((unsigned)(pgn) & (TLB_SETS - 1))
+
+void tlb_init(int nr_cpus)
+{
+  tlbs = calloc(nr_cpus, sizeof(struct tlb));
+  nr_tlbs = nr_cpus;
+}
+
+void tlb_free(void)
+{
+  free(tlbs);
+  tlbs = NULL;
+  cur = NULL;
+  nr_tlbs = 0;
+}
+
+static void tlb_flush(struct tlb *tlb)
+{
+  memset(tlb->set, 0, sizeof(tlb->set));
+  tlb->flushes++;
+}
+
+/*
+ *tlb_switch - select the TLB of a CPU
+ *@cpu: CPU about to run a slot
+ *@proc: process it runs
+ */
+void tlb_switch(int cpu, struct pcb_t *proc)
+{
+  struct tlb *tlb = &tlbs[cpu];
+
+  cur = tlb;
+#ifdef MM_PAGING
+  // * The entries may be stale if the process ran on another CPU since
+  if (tlb->pid != proc->pid || proc->mm->tlb_cpu != cpu)
+  {
+    if (tlb->pid != 0)
+      tlb_flush(tlb);
+    tlb->pid = proc->pid;
+    proc->mm->tlb_cpu = cpu;
+  }
+#endif
+}
+
+/*
+ *tlb_lookup - translate a page through the current TLB
+ *@pid: process owning the page
+ *@pgn: page number
+ *@fpn: return frame number
+ */
+int tlb_lookup(uint32_t pid, int pgn, int *fpn)
+{
+  struct tlb_entry *e;
+  int way;
+
+  if (cur == NULL)
+    return -1;
+
+  e = cur->set[TLB_SET(pgn)];
+  for (way = 0; way < TLB_WAYS; way++)
+  {
+    if (e[way].valid && e[way].pgn == pgn && e[way].pid == pid)
+    {
+      *fpn = e[way].fpn;
+      cur->hits++;
+      return 0;
+    }
+  }
+  cur->misses++;
+  return -1;
+}
+
+/*
+ *tlb_insert - cache a translation in the current TLB
+ *@pid: process owning the page
+ *@pgn: page number
+ *@fpn: frame number
+ *@pte: PTE the translation comes from
+ */
+void tlb_insert(uint32_t pid, int pgn, int fpn, uint32_t *pte)
+{
+  int s = TLB_SET(pgn);
+  struct tlb_entry *e;
+
+  if (cur == NULL)
+    return;
+
+  e = &cur->set[s][cur->next[s]];
+  cur->next[s] = (cur->next[s] + 1) % TLB_WAYS;
+  e->pid = pid;
+  e->pgn = pgn;
+  e->fpn = fpn;
+  e->pte = pte;
+  e->valid = 1;
+}
+
+void tlb_invalidate(uint32_t pid, int pgn)
+{
+  struct tlb_entry *e;
+  int way;
+
+  if (cur == NULL)
+    return;
+
+  e = cur->set[TLB_SET(pgn)];
+  for (way = 0; way < TLB_WAYS; way++)
+    if (e[way].pgn == pgn && e[way].pid == pid)
+      e[way].valid = 0;
+}
+
+/*
+ * The PTE of a process only changes while it runs, so only the current
+ * TLB can hold a translation read from it
+ */
+void tlb_invalidate_pte(uint32_t *pte)
+{
+  int s, way;
+
+  if (cur == NULL)
+    return;
+
+  for (s = 0; s < TLB_SETS; s++)
+    for (way = 0; way < TLB_WAYS; way++)
+      if (cur->set[s][way].pte == pte)
+        cur->set[s][way].valid = 0;
+}
+
+void tlb_stats(unsigned long *hits, unsigned long *misses, unsigned long *flushes)
+{
+  int i;
+
+  *hits = *misses = *flushes = 0;
+  for (i = 0; i < nr_tlbs; i++)
+  {
+    *hits += tlbs[i].hits;
+    *misses += tlbs[i].misses;
+    *flushes += tlbs[i].flushes;
+  }
+}
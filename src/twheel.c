@@ -0,0 +1,170 @@
+#include <string.h>
+#include "twheel.h"
+
+/*
+! File a timer in the slot matching its distance from now
+* @param w: wheel to file into
+* @param t: timer, not linked anywhere
+* @note: a timer farther than TW_SPAN is filed at TW_SPAN and filed again
+*        when it comes up
+*/
+static void tw_place(struct twheel * w, struct tw_timer * t) {
+        uint64_t expires = t->expires;
+        uint64_t delta;
+        int level = 0;
+
+        if (expires - w->now >= TW_SPAN)
+                expires = w->now + TW_SPAN - 1;
+        delta = expires - w->now;
+        // * The level is the first one whose reach covers the distance
+        while (delta >= (1ULL << (TW_BITS * (level + 1))))
+                level++;
+
+        int slot = (expires >> (TW_BITS * level)) & TW_MASK;
+        struct tw_timer ** head = &w->slots[level][slot];
+        t->level = level;
+        t->slot = slot;
+        t->next = *head;
+        if (*head)
+                (*head)->pprev = &t->next;
+        t->pprev = head;
+        *head = t;
+        w->occupied[level] |= 1ULL << slot;
+}
+
+/*
+! Take the whole list out of a slot
+* @return: the first timer of the list, its timers still point in the slot
+*/
+static struct tw_timer * tw_take(struct twheel * w, int level, int slot) {
+        struct tw_timer * list = w->slots[level][slot];
+        w->slots[level][slot] = NULL;
+        w->occupied[level] &= ~(1ULL << slot);
+        return list;
+}
+
+void tw_init(struct twheel * w, uint64_t now) {
+        memset(w, 0, sizeof(*w));
+        w->now = now;
+}
+
+/*
+! Arm a timer
+* @param w: wheel to arm it on
+* @param t: timer, must not be armed
+* @param expires: tick to fire in
+* @param fn: called with [t] when it fires
+*/
+void tw_arm(struct twheel * w, struct tw_timer * t, uint64_t expires,
+            void (*fn)(struct tw_timer *)) {
+        t->expires = expires > w->now ? expires : w->now + 1;
+        t->fn = fn;
+        tw_place(w, t);
+        w->pending++;
+}
+
+int tw_cancel(struct twheel * w, struct tw_timer * t) {
+        if (!tw_armed(t))
+                return 0;
+        *t->pprev = t->next;
+        if (t->next)
+                t->next->pprev = t->pprev;
+        else if (w->slots[t->level][t->slot] == NULL)
+                w->occupied[t->level] &= ~(1ULL << t->slot);
+        t->pprev = NULL;
+        w->pending--;
+        return 1;
+}
+
+/*
+! Run one tick, w->now is the tick to run
+* @note: when level k wraps, its next coarser slot is refiled first, so a
+*        timer always reaches level 0 before it is due
+*/
+static void tw_tick(struct twheel * w) {
+        int slot = w->now & TW_MASK;
+        int level;
+
+        // * Refile the coarse slots that start at this tick
+        for (level = 1; level < TW_LEVELS && slot == 0; level++) {
+                slot = (w->now >> (TW_BITS * level)) & TW_MASK;
+                struct tw_timer * t = tw_take(w, level, slot);
+                while (t) {
+                        struct tw_timer * next = t->next;
+                        tw_place(w, t);
+                        t = next;
+                }
+        }
+
+        // * Fire what is due, far timers filed at TW_SPAN go around again
+        struct tw_timer * t = tw_take(w, 0, w->now & TW_MASK);
+        while (t) {
+                struct tw_timer * next = t->next;
+                if (t->expires > w->now) {
+                        tw_place(w, t);
+                }else{
+                        t->pprev = NULL;
+                        w->pending--;
+                        t->fn(t);
+                }
+                t = next;
+        }
+}
+
+/*
+! Advance the wheel
+* @param w: wheel to advance
+* @param now: tick to move to, every tick up to it runs
+* @note: stretches with nothing filed on level 0 are crossed in one step,
+*        stopping only where a coarser slot needs refiling
+*/
+void tw_advance(struct twheel * w, uint64_t now) {
+        while (w->now < now) {
+                if (w->pending == 0) {
+                        w->now = now;
+                        break;
+                }
+                // * Next filled level 0 slot of this round, or the round end
+                int slot = w->now & TW_MASK;
+                uint64_t ahead = slot == TW_MASK ? 0 : w->occupied[0] >> (slot + 1);
+                uint64_t next = ahead ? w->now + 1 + __builtin_ctzll(ahead)
+                                      : (w->now | TW_MASK) + 1;
+                if (next > now) {
+                        w->now = now;
+                        break;
+                }
+                w->now = next;
+                tw_tick(w);
+        }
+}
+
+uint64_t tw_next(const struct twheel * w) {
+        uint64_t best = UINT64_MAX;
+        int level;
+
+        if (w->pending == 0)
+                return best;
+        for (level = 0; level < TW_LEVELS; level++) {
+                int shift = TW_BITS * level;
+                int slot = (w->now >> shift) & TW_MASK;
+                uint64_t occ = w->occupied[level];
+                if (occ == 0)
+                        continue;
+                // * First filled slot after the current one, wrapping around
+                uint64_t rot = (occ >> ((slot + 1) & TW_MASK)) |
+                               (occ << ((TW_SIZE - slot - 1) & TW_MASK));
+                int dist = 1 + __builtin_ctzll(rot);
+                uint64_t start = ((w->now >> shift) + dist) << shift;
+                if (level == TW_LEVELS - 1) {
+                        // * Far timers may sit here early, bound by the slot
+                        if (start < best)
+                                best = start;
+                        continue;
+                }
+                const struct tw_timer * t;
+                for (t = w->slots[level][(slot + dist) & TW_MASK]; t; t = t->next)
+                        if (t->expires < best)
+                                best = t->expires;
+        }
+        return best;
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Whole-simulator tests: run configs from input/ through ./os and check
+# what the engines print. Run from the top directory after make.
+
+RED="\033[31m"
+GREEN="\033[32m"
+YELLOW="\033[33m"
+RESET="\033[0m"
+
+OS=./os
+total_tests=0
+passed_tests=0
+
+# print_result name expected actual: passes when both are the same
+print_result() {
+    total_tests=$((total_tests + 1))
+    if [ "$2" = "$3" ]; then
+        passed_tests=$((passed_tests + 1))
+        printf "${GREEN}[PASS]${RESET} Test: %s\n" "$1"
+    else
+        printf "${RED}[FAIL]${RESET} Test: %s\n" "$1"
+        printf "  Expected: %s\n" "$2"
+        printf "  Actual:   %s\n" "$3"
+    fi
+}
+
+# run config options...: the output of a run, empty if it did not end
+run() {
+    timeout 20 $OS "$@" 2>&1 || echo "exit status $?"
+}
+
+printf "${YELLOW}======= Simulator Test Suite =======${RESET}\n"
+
+# killall under engine=event: the CPU must go to sleep once the only
+# process left waits on its timer, so tickless skips the empty slots
+printf "\n${YELLOW}=== Running test: killall under engine=event ===${RESET}\n"
+event=$(run os_killall_timer engine=event tickless=1)
+thread=$(run os_killall_timer engine=thread tickless=1)
+print_result "killall - p0s killed" \
+    "Killing process PID=1, name=\"input/proc/p0s\"" \
+    "$(echo "$event" | grep '^Killing' | sed 's/ from .*//')"
+print_result "killall - Ends with the sleeper" "CPU 0 stopped" \
+    "$(echo "$event" | grep -o 'CPU 0 stopped')"
+print_result "killall - Slots printed as on engine=thread" \
+    "$(echo "$thread" | grep -c '^Time slot')" \
+    "$(echo "$event" | grep -c '^Time slot')"
+
+# engine=thread and engine=event run the slot in the same order on one
+# CPU, so they must agree on the trace, the slot count and the idle column
+printf "\n${YELLOW}=== Running test: engine parity ===${RESET}\n"
+for config in sched_0 sched_1 os_1_singleCPU_mlq_paging os_syscall os_sc \
+              "os_killall_timer tickless=1"; do
+    thread=$(run $config engine=thread | sed -E 's/, [0-9.]+s wall clock.*//')
+    event=$(run $config engine=event | sed -E 's/, [0-9.]+s wall clock.*//')
+    print_result "$config - Slot count" \
+        "$(echo "$thread" | grep 'instructions in')" \
+        "$(echo "$event" | grep 'instructions in')"
+    print_result "$config - CPU counters" \
+        "$(echo "$thread" | grep '^	cpu ')" \
+        "$(echo "$event" | grep '^	cpu ')"
+    print_result "$config - Trace" \
+        "$(echo "$thread" | md5sum)" "$(echo "$event" | md5sum)"
+done
+
+printf "\n${YELLOW}======= Test Summary =======${RESET}\n"
+printf "Tests passed: %d/%d\n" $passed_tests $total_tests
+if [ $passed_tests -eq $total_tests ]; then
+    printf "Overall result: ${GREEN}ALL TESTS PASSED${RESET}\n"
+    exit 0
+fi
+printf "Overall result: ${RED}SOME TESTS FAILED${RESET}\n"
+exit 1
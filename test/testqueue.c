@@ -6,6 +6,8 @@
 #include <fcntl.h>
 #include "common.h"
 #include "queue.h"
+#include "event.h"
+#include "twheel.h"
 
 // Define colorful output for test results
 #define RED     "\033[31m"
@@ -72,36 +74,38 @@ int test_empty_queue() {
 int test_enqueue() {
     printf("\n%s=== Running test: enqueue ===%s\n", YELLOW, RESET);
     
-    struct queue_t queue;
-    queue.size = 0;
+    struct queue_t queue = {0};
     
     // Test 2.1: Enqueue to empty queue
     struct pcb_t* pcb1 = create_dummy_pcb(1, 1);
     enqueue(&queue, pcb1);
-    int pass1 = (queue.size == 1 && queue.proc[0] == pcb1);
+    int pass1 = (queue.size == 1 && queue_at(&queue, 0) == pcb1);
     char expected[128], actual[128];
     sprintf(expected, "size=1, proc[0]=pcb1");
-    sprintf(actual, "size=%d, proc[0]=%s", queue.size, (queue.size > 0 && queue.proc[0] == pcb1) ? "pcb1" : "wrong pcb");
+    sprintf(actual, "size=%d, proc[0]=%s", queue.size, queue_at(&queue, 0) == pcb1 ? "pcb1" : "wrong pcb");
     print_result("enqueue - Empty queue", expected, actual, pass1);
     
     // Test 2.2: Enqueue to non-empty queue
     struct pcb_t* pcb2 = create_dummy_pcb(2, 2);
     enqueue(&queue, pcb2);
-    int pass2 = (queue.size == 2 && queue.proc[1] == pcb2);
+    int pass2 = (queue.size == 2 && queue_at(&queue, 1) == pcb2);
     sprintf(expected, "size=2, proc[1]=pcb2");
-    sprintf(actual, "size=%d, proc[1]=%s", queue.size, (queue.size > 1 && queue.proc[1] == pcb2) ? "pcb2" : "wrong pcb");
+    sprintf(actual, "size=%d, proc[1]=%s", queue.size, queue_at(&queue, 1) == pcb2 ? "pcb2" : "wrong pcb");
     print_result("enqueue - Non-empty queue", expected, actual, pass2);
     
-    // Test 2.3: Enqueue to full queue (should not add)
-    queue.size = MAX_QUEUE_SIZE;
+    // Test 2.3: Enqueue past the initial capacity (should grow, never drop)
+    const int many = 10 * QUEUE_INIT_CAPACITY;
     struct pcb_t* pcb3 = create_dummy_pcb(3, 3);
-    enqueue(&queue, pcb3);
-    int pass3 = (queue.size == MAX_QUEUE_SIZE); // Size should remain the same
-    sprintf(expected, "size=%d", MAX_QUEUE_SIZE);
+    for (int i = 0; i < many; i++)
+        enqueue(&queue, pcb3);
+    int pass3 = (queue.size == many + 2 && queue_at(&queue, 1) == pcb2
+                 && queue_at(&queue, many + 1) == pcb3);
+    sprintf(expected, "size=%d", many + 2);
     sprintf(actual, "size=%d", queue.size);
-    print_result("enqueue - Full queue", expected, actual, pass3);
+    print_result("enqueue - Grows past initial capacity", expected, actual, pass3);
     
     // Cleanup
+    free_queue(&queue);
     free(pcb1);
     free(pcb2);
     free(pcb3);
@@ -114,8 +118,7 @@ int test_dequeue() {
     printf("\n%s=== Running test: dequeue ===%s\n", YELLOW, RESET);
     
     // Test 3.1: Dequeue from empty queue
-    struct queue_t empty_queue;
-    empty_queue.size = 0;
+    struct queue_t empty_queue = {0};
     struct pcb_t* result1 = dequeue(&empty_queue);
     int pass1 = (result1 == NULL);
     char expected[128], actual[128];
@@ -124,13 +127,9 @@ int test_dequeue() {
     print_result("dequeue - Empty queue", expected, actual, pass1);
     
     // Test 3.2: Dequeue from queue with one element
-    struct queue_t single_queue;
-    single_queue.size = 1;
-    struct pcb_t* pcb1 = create_dummy_pcb(1, 1);
-#ifdef MLQ_SCHED
-    pcb1->prio = 5; // Lower priority number means higher priority
-#endif
-    single_queue.proc[0] = pcb1;
+    struct queue_t single_queue = {0};
+    struct pcb_t* pcb1 = create_dummy_pcb(1, 5);
+    enqueue(&single_queue, pcb1);
     
     struct pcb_t* result2 = dequeue(&single_queue);
     int pass2 = (result2 == pcb1 && single_queue.size == 0);
@@ -138,37 +137,20 @@ int test_dequeue() {
     sprintf(actual, "%s, new size=%d", result2 == pcb1 ? "pcb1" : "wrong pcb", single_queue.size);
     print_result("dequeue - Single element queue", expected, actual, pass2);
     
-    // Test 3.3: Dequeue from queue with multiple elements (priority based)
-    struct queue_t multi_queue;
-    multi_queue.size = 3;
+    // Test 3.3: Dequeue from queue with multiple elements (FIFO order,
+    // every process of one MLQ level shares the same priority)
+    struct queue_t multi_queue = {0};
     
     struct pcb_t* pcb2 = create_dummy_pcb(2, 10);
-    struct pcb_t* pcb3 = create_dummy_pcb(3, 5);  // Higher priority (lower number)
+    struct pcb_t* pcb3 = create_dummy_pcb(3, 5);
     struct pcb_t* pcb4 = create_dummy_pcb(4, 15);
     
-#ifdef MLQ_SCHED
-    pcb2->prio = 10;
-    pcb3->prio = 5;   // Highest priority (lowest number)
-    pcb4->prio = 15;
-#endif
-    
-    multi_queue.proc[0] = pcb2;
-    multi_queue.proc[1] = pcb3;
-    multi_queue.proc[2] = pcb4;
+    enqueue(&multi_queue, pcb2);
+    enqueue(&multi_queue, pcb3);
+    enqueue(&multi_queue, pcb4);
     
     struct pcb_t* result3 = dequeue(&multi_queue);
     
-#ifdef MLQ_SCHED
-    // In MLQ scheduler, it should return the highest priority process (pcb3)
-    int pass3 = (result3 == pcb3 && multi_queue.size == 2);
-    sprintf(expected, "pcb3 (prio=5), new size=2");
-    sprintf(actual, "%s, new size=%d", 
-            result3 == pcb3 ? "pcb3 (prio=5)" : 
-            result3 == pcb2 ? "pcb2 (prio=10)" : 
-            result3 == pcb4 ? "pcb4 (prio=15)" : "wrong pcb", 
-            multi_queue.size);
-#else
-    // In non-MLQ, it might default to FIFO, so it would return pcb2
     int pass3 = (result3 == pcb2 && multi_queue.size == 2);
     sprintf(expected, "pcb2, new size=2");
     sprintf(actual, "%s, new size=%d", 
@@ -176,16 +158,261 @@ int test_dequeue() {
             result3 == pcb3 ? "pcb3" : 
             result3 == pcb4 ? "pcb4" : "wrong pcb", 
             multi_queue.size);
-#endif
     
-    print_result("dequeue - Multiple element queue (priority)", expected, actual, pass3);
+    print_result("dequeue - Multiple element queue (FIFO)", expected, actual, pass3);
+    
+    // Test 3.4: FIFO order survives the ring wrapping around while growing
+    struct queue_t ring = {0};
+    struct pcb_t* ids[3 * QUEUE_INIT_CAPACITY];
+    int head = 0, tail = 0, pass4 = 1;
+    for (int i = 0; i < 3 * QUEUE_INIT_CAPACITY; i++)
+        ids[i] = create_dummy_pcb(100 + i, 0);
+    // Keep the queue half drained so head moves before every growth
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < QUEUE_INIT_CAPACITY; i++)
+            enqueue(&ring, ids[tail++]);
+        for (int i = 0; i < QUEUE_INIT_CAPACITY / 2; i++)
+            if (dequeue(&ring) != ids[head++])
+                pass4 = 0;
+    }
+    while (!empty(&ring))
+        if (dequeue(&ring) != ids[head++])
+            pass4 = 0;
+    pass4 = pass4 && (head == tail);
+    sprintf(expected, "%d processes out in insertion order", tail);
+    sprintf(actual, "%d processes out, order %s", head, pass4 ? "kept" : "broken");
+    print_result("dequeue - FIFO across wrap-around and growth", expected, actual, pass4);
     
     // Cleanup
+    free_queue(&multi_queue);
+    free_queue(&single_queue);
+    free_queue(&ring);
+    for (int i = 0; i < 3 * QUEUE_INIT_CAPACITY; i++)
+        free(ids[i]);
     free(pcb1);
     free(pcb2);
     free(pcb3);
     free(pcb4);
     
+    return (pass1 && pass2 && pass3 && pass4);
+}
+
+// Test heap-backed priority queue
+int test_prio_queue() {
+    printf("\n%s=== Running test: priority queue ===%s\n", YELLOW, RESET);
+    
+    char expected[128], actual[128];
+    
+    // Test 4.1: Dequeue from empty priority queue
+    struct prio_queue_t pq = {0};
+    int pass1 = (pq_dequeue(&pq) == NULL && pq_peek(&pq) == NULL && pq_empty(&pq));
+    print_result("pq_dequeue - Empty queue", "NULL", pass1 ? "NULL" : "not NULL", pass1);
+    
+    // Test 4.2: Smallest key first, equal keys in insertion order
+    uint64_t keys[6] = {5, 1, 3, 1, 5, 0};
+    int order[6] = {5, 1, 3, 2, 0, 4};   // indices expected out
+    struct pcb_t* pcbs[6];
+    for (int i = 0; i < 6; i++) {
+        pcbs[i] = create_dummy_pcb(i, keys[i]);
+        pq_enqueue(&pq, pcbs[i], keys[i]);
+    }
+    int pass2 = (pq_peek(&pq) == pcbs[5]);
+    char *p = actual;
+    p += sprintf(p, "PIDs:");
+    for (int i = 0; i < 6; i++) {
+        struct pcb_t* out = pq_dequeue(&pq);
+        p += sprintf(p, " %d", out ? (int)out->pid : -1);
+        if (out != pcbs[order[i]])
+            pass2 = 0;
+    }
+    sprintf(expected, "PIDs: 5 1 3 2 0 4");
+    print_result("pq_dequeue - Key order with FIFO ties", expected, actual, pass2);
+    
+    // Test 4.3: Heap order holds past the initial capacity
+    const int many = 10 * QUEUE_INIT_CAPACITY;
+    struct pcb_t* dummy = create_dummy_pcb(99, 0);
+    for (int i = 0; i < many; i++)
+        pq_enqueue(&pq, dummy, (uint64_t)((i * 37) % many));
+    int pass3 = (pq.size == many);
+    uint64_t prev = 0;
+    for (int i = 0; i < many; i++) {
+        uint64_t key = pq.heap[0].key;
+        if (key < prev)
+            pass3 = 0;
+        prev = key;
+        pq_dequeue(&pq);
+    }
+    pass3 = pass3 && pq_empty(&pq);
+    sprintf(expected, "%d keys out in non-decreasing order", many);
+    sprintf(actual, "order %s", pass3 ? "kept" : "broken");
+    print_result("pq_dequeue - Grows past initial capacity", expected, actual, pass3);
+    
+    // Cleanup
+    free_pq(&pq);
+    for (int i = 0; i < 6; i++)
+        free(pcbs[i]);
+    free(dummy);
+    
+    return (pass1 && pass2 && pass3);
+}
+
+// Order rbtree nodes embedded in pcbs by vruntime
+static int by_vruntime(const struct rb_node* a, const struct rb_node* b) {
+    return rb_entry(a, struct pcb_t, run_node)->vruntime
+         < rb_entry(b, struct pcb_t, run_node)->vruntime;
+}
+
+// Black height of a subtree, -1 if a red-black property is broken
+static int rb_check(const struct rb_node* node) {
+    if (node == NULL)
+        return 1;
+    if (node->color == RB_RED &&
+        ((node->left && node->left->color == RB_RED) ||
+         (node->right && node->right->color == RB_RED)))
+        return -1;
+    int left = rb_check(node->left);
+    int right = rb_check(node->right);
+    if (left < 0 || left != right)
+        return -1;
+    return left + (node->color == RB_BLACK);
+}
+
+// Test the red-black tree used by the cfs policy
+int test_rbtree() {
+    printf("\n%s=== Running test: red-black tree ===%s\n", YELLOW, RESET);
+    
+    char expected[128], actual[128];
+    struct rb_root root = {0};
+    
+    // Test 5.1: Empty tree has no first node
+    int pass1 = (rb_first(&root) == NULL && root.count == 0);
+    print_result("rb_first - Empty tree", "NULL", pass1 ? "NULL" : "not NULL", pass1);
+    
+    // Test 5.2: In-order walk is sorted and the tree stays balanced
+    const int many = 200;
+    struct pcb_t* pcbs[200];
+    for (int i = 0; i < many; i++) {
+        pcbs[i] = create_dummy_pcb(i, 0);
+        pcbs[i]->vruntime = (uint64_t)((i * 73) % many);
+        rb_insert(&root, &pcbs[i]->run_node, by_vruntime);
+    }
+    int pass2 = (root.count == many) && (rb_check(root.node) > 0);
+    uint64_t prev = 0;
+    int walked = 0;
+    for (struct rb_node* n = rb_first(&root); n != NULL; n = rb_next(n)) {
+        uint64_t key = rb_entry(n, struct pcb_t, run_node)->vruntime;
+        if (key < prev)
+            pass2 = 0;
+        prev = key;
+        walked++;
+    }
+    pass2 = pass2 && (walked == many);
+    sprintf(expected, "%d nodes in order, valid red-black tree", many);
+    sprintf(actual, "%d nodes walked, tree %s", walked, pass2 ? "valid" : "broken");
+    print_result("rb_insert - Sorted and balanced", expected, actual, pass2);
+    
+    // Test 5.3: Erasing keeps the invariants and the cached leftmost node
+    for (int i = 0; i < many; i += 2)
+        rb_erase(&root, &pcbs[i]->run_node);
+    int pass3 = (root.count == many / 2) && (rb_check(root.node) > 0);
+    uint64_t lowest = (uint64_t)-1;
+    for (int i = 1; i < many; i += 2)
+        if (pcbs[i]->vruntime < lowest)
+            lowest = pcbs[i]->vruntime;
+    struct rb_node* first = rb_first(&root);
+    pass3 = pass3 && first && rb_entry(first, struct pcb_t, run_node)->vruntime == lowest;
+    while ((first = rb_first(&root)) != NULL)
+        rb_erase(&root, first);
+    pass3 = pass3 && (root.node == NULL) && (root.count == 0);
+    sprintf(expected, "valid tree, leftmost key %lu, then empty", (unsigned long)lowest);
+    sprintf(actual, "tree %s", pass3 ? "valid" : "broken");
+    print_result("rb_erase - Invariants and leftmost cache", expected, actual, pass3);
+    
+    for (int i = 0; i < many; i++)
+        free(pcbs[i]);
+    
+    return (pass1 && pass2 && pass3);
+}
+
+int test_event_queue() {
+    printf("\n%s=== Running test: event queue ===%s\n", YELLOW, RESET);
+    
+    char expected[128], actual[128];
+    struct event_queue_t q = {0};
+    struct event ev;
+    
+    // Test 6.1: Empty queue has nothing to pop
+    int pass1 = (event_pop(&q, &ev) == 0);
+    print_result("event_pop - Empty queue", "0", pass1 ? "0" : "1", pass1);
+    
+    // Test 6.2: Events fire by slot, timers, loader, then CPUs by id
+    event_push(&q, (struct event){ 5, EVENT_CPU, 0 });
+    event_push(&q, (struct event){ 3, EVENT_TIMER, 0 });
+    event_push(&q, (struct event){ 3, EVENT_LOAD, 0 });
+    event_push(&q, (struct event){ 3, EVENT_CPU, 2 });
+    event_push(&q, (struct event){ 3, EVENT_CPU, 1 });
+    event_push(&q, (struct event){ 1, EVENT_CPU, 3 });
+    int order = 0;
+    actual[0] = '\0';
+    while (event_pop(&q, &ev)) {
+        order++;
+        sprintf(actual + strlen(actual), "%s%lu:%s%d", order > 1 ? " " : "",
+                (unsigned long)ev.time, ev.kind == EVENT_TIMER ? "T" : ev.kind == EVENT_LOAD ? "L" : "C", ev.id);
+    }
+    sprintf(expected, "1:C3 3:T0 3:L0 3:C1 3:C2 5:C0");
+    int pass2 = (strcmp(expected, actual) == 0);
+    print_result("event_pop - Slot, kind and id order", expected, actual, pass2);
+    
+    free_event_queue(&q);
+    
+    return (pass1 && pass2);
+}
+
+static struct twheel test_wheel;
+static int fired_late = 0;
+static int fired_count = 0;
+
+static void record_fire(struct tw_timer* t) {
+    if (t->expires != test_wheel.now)
+        fired_late++;
+    fired_count++;
+}
+
+int test_timing_wheel() {
+    printf("\n%s=== Running test: timing wheel ===%s\n", YELLOW, RESET);
+    
+    char expected[128], actual[128];
+    // Spread over every level, one past the wheel span and one cancelled
+    uint64_t when[] = { 3, 63, 64, 65, 200, 4095, 4097, 70000, 300000,
+                        TW_SPAN + 12345, 100 };
+    const int n = sizeof(when) / sizeof(when[0]);
+    struct tw_timer timers[11];
+    
+    tw_init(&test_wheel, 0);
+    for (int i = 0; i < n; i++)
+        tw_arm(&test_wheel, &timers[i], when[i], record_fire);
+    
+    // Test 7.1: The next expiry is exact and cancel disarms in place
+    int cancelled = tw_cancel(&test_wheel, &timers[n - 1]);
+    int pass1 = cancelled && !tw_armed(&timers[n - 1]) &&
+                test_wheel.pending == n - 1 && tw_next(&test_wheel) == 3;
+    sprintf(expected, "next 3, %d pending", n - 1);
+    sprintf(actual, "next %lu, %d pending", (unsigned long)tw_next(&test_wheel), test_wheel.pending);
+    print_result("tw_cancel/tw_next - Before any tick", expected, actual, pass1);
+    
+    // Test 7.2: Every timer fires in its own tick, across jumps
+    uint64_t stops[] = { 2, 64, 4096, 4097, 250000, TW_SPAN * 2 };
+    for (int i = 0; i < 6; i++)
+        tw_advance(&test_wheel, stops[i]);
+    int pass2 = (fired_count == n - 1) && (fired_late == 0) && (test_wheel.pending == 0);
+    sprintf(expected, "%d fired on time, 0 pending", n - 1);
+    sprintf(actual, "%d fired, %d late, %d pending", fired_count, fired_late, test_wheel.pending);
+    print_result("tw_advance - Fire on the expiry tick", expected, actual, pass2);
+    
+    // Test 7.3: Nothing armed, nothing next
+    int pass3 = (tw_next(&test_wheel) == UINT64_MAX);
+    print_result("tw_next - Empty wheel", "none", pass3 ? "none" : "some", pass3);
+    
     return (pass1 && pass2 && pass3);
 }
 
@@ -209,6 +436,10 @@ int main() {
     int test1 = test_empty_queue();
     int test2 = test_enqueue();
     int test3 = test_dequeue();
+    int test4 = test_prio_queue();
+    int test5 = test_rbtree();
+    int test6 = test_event_queue();
+    int test7 = test_timing_wheel();
 
     // Khôi phục stdout gốc
     dup2(stdout_backup, STDOUT_FILENO);
@@ -221,8 +452,12 @@ int main() {
     printf("\nTest empty queue:   %s%s%s\n", test1 ? GREEN : RED, test1 ? "PASSED" : "FAILED", RESET);
     printf("Test enqueue:       %s%s%s\n", test2 ? GREEN : RED, test2 ? "PASSED" : "FAILED", RESET);
     printf("Test dequeue:       %s%s%s\n", test3 ? GREEN : RED, test3 ? "PASSED" : "FAILED", RESET);
+    printf("Test prio queue:    %s%s%s\n", test4 ? GREEN : RED, test4 ? "PASSED" : "FAILED", RESET);
+    printf("Test rbtree:        %s%s%s\n", test5 ? GREEN : RED, test5 ? "PASSED" : "FAILED", RESET);
+    printf("Test event queue:   %s%s%s\n", test6 ? GREEN : RED, test6 ? "PASSED" : "FAILED", RESET);
+    printf("Test timing wheel:  %s%s%s\n", test7 ? GREEN : RED, test7 ? "PASSED" : "FAILED", RESET);
     
-    int all_passed = test1 && test2 && test3;
+    int all_passed = test1 && test2 && test3 && test4 && test5 && test6 && test7;
     
     printf("\n%s===========================%s\n", YELLOW, RESET);
     printf("Overall result: %s%s%s\n", all_passed ? GREEN : RED, 
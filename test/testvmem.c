@@ -8,6 +8,7 @@
 #include "os-mm.h"
 #include "mm.h"
 #include "libmem.h"
+#include "tlb.h"
 struct vm_rg_struct *get_vm_area_node_at_brk(struct pcb_t *caller, int vmaid, int size, int alignedsz);
 
 // Define colorful output for test results
@@ -1211,6 +1212,172 @@ int test_memory_stress() {
 }
 
 // Add these tests to main()
+/* Test 17: TLB - tlb_lookup, tlb_insert, invalidation and flushes */
+int test_tlb() {
+    printf("\n%s=== Running test: TLB ===%s\n", YELLOW, RESET);
+
+    struct pcb_t *proc = setup_test_process(0);
+    char expected[128], actual[128];
+    int fpn = -1;
+    unsigned long hits, misses, flushes;
+
+    tlb_init(2);
+    tlb_switch(0, proc);
+
+    // Test 17.1: A cached translation hits
+    tlb_insert(proc->pid, 5, 42, &proc->mm->pgd[5]);
+    int ret1 = tlb_lookup(proc->pid, 5, &fpn);
+    int pass1 = (ret1 == 0 && fpn == 42);
+    sprintf(expected, "hit, fpn 42");
+    sprintf(actual, "%s, fpn %d", ret1 == 0 ? "hit" : "miss", fpn);
+    print_result("TLB - Lookup after insert", expected, actual, pass1);
+
+    // Test 17.2: Other processes and pages miss
+    int pass2 = (tlb_lookup(proc->pid + 1, 5, &fpn) != 0 &&
+                 tlb_lookup(proc->pid, 5 + TLB_SETS, &fpn) != 0);
+    sprintf(expected, "other pid and pgn miss");
+    sprintf(actual, "%s", pass2 ? "other pid and pgn miss" : "hit");
+    print_result("TLB - Lookup is keyed by (pid, pgn)", expected, actual, pass2);
+
+    // Test 17.3: Changing the PTE drops the translation
+    pte_set_fpn(&proc->mm->pgd[5], 7);
+    int pass3 = (tlb_lookup(proc->pid, 5, &fpn) != 0);
+    sprintf(expected, "miss after pte_set_fpn");
+    sprintf(actual, "%s after pte_set_fpn", pass3 ? "miss" : "hit");
+    print_result("TLB - pte_set_fpn invalidates", expected, actual, pass3);
+
+    // Test 17.4: Victim selection drops the translation
+    tlb_insert(proc->pid, 6, 8, &proc->mm->pgd[6]);
+    tlb_invalidate(proc->pid, 6);
+    int pass4 = (tlb_lookup(proc->pid, 6, &fpn) != 0);
+    sprintf(expected, "miss after tlb_invalidate");
+    sprintf(actual, "%s after tlb_invalidate", pass4 ? "miss" : "hit");
+    print_result("TLB - Victim page invalidates", expected, actual, pass4);
+
+    // Test 17.5: Running on another CPU in between flushes the TLB
+    tlb_insert(proc->pid, 9, 3, &proc->mm->pgd[9]);
+    tlb_switch(1, proc);
+    tlb_switch(0, proc);
+    int pass5 = (tlb_lookup(proc->pid, 9, &fpn) != 0);
+    tlb_stats(&hits, &misses, &flushes);
+    pass5 = pass5 && hits == 1 && misses == 5 && flushes == 1;
+    sprintf(expected, "miss, 1 hit, 5 misses, 1 flush");
+    sprintf(actual, "%s, %lu hit, %lu misses, %lu flush",
+            pass5 ? "miss" : "hit", hits, misses, flushes);
+    print_result("TLB - Migration flushes", expected, actual, pass5);
+
+    tlb_free();
+    cleanup_test_process(proc, 0);
+    return (pass1 && pass2 && pass3 && pass4 && pass5);
+}
+
+/* Test 18: Block instructions - writeblk, memcpy, memset, readblk across pages */
+int test_block_io() {
+    printf("\n%s=== Running test: Block I/O ===%s\n", YELLOW, RESET);
+
+    struct pcb_t *proc = setup_test_process(1);
+    char expected[128], actual[128];
+    BYTE b[4];
+
+    // Test 18.1: Two regions spanning several pages each
+    pthread_mutex_lock(&mmvm_lock);
+    int a1 = liballoc(proc, 600, 1);
+    int a2 = liballoc(proc, 600, 2);
+    pthread_mutex_unlock(&mmvm_lock);
+    int pass1 = (a1 >= 0 && a2 >= 0);
+    sprintf(expected, "both allocations succeed");
+    sprintf(actual, "liballoc returns %d, %d", a1, a2);
+    print_result("Block I/O - Allocate regions", expected, actual, pass1);
+
+    // Test 18.2: writeblk then memcpy carries every byte over page boundaries
+    int r1 = libwriteblk(proc, 7, 1, 0, 600);
+    int r2 = libmemcpy(proc, 1, 2, 0, 600);
+    __read(proc, 0, 2, 0, &b[0]);
+    __read(proc, 0, 2, 255, &b[1]);
+    __read(proc, 0, 2, 256, &b[2]);
+    __read(proc, 0, 2, 599, &b[3]);
+    int pass2 = (r1 == 0 && r2 == 0 && b[0] == 7 && b[1] == (BYTE)(7 + 255) &&
+                 b[2] == (BYTE)(7 + 256) && b[3] == (BYTE)(7 + 599));
+    sprintf(expected, "0x07 0x06 0x07 0x5e");
+    sprintf(actual, "0x%02x 0x%02x 0x%02x 0x%02x", (unsigned char)b[0], (unsigned char)b[1],
+            (unsigned char)b[2], (unsigned char)b[3]);
+    print_result("Block I/O - writeblk and memcpy", expected, actual, pass2);
+
+    // Test 18.3: memset only touches its block
+    int r3 = libmemset(proc, 0xAA, 2, 100, 300);
+    __read(proc, 0, 2, 99, &b[0]);
+    __read(proc, 0, 2, 100, &b[1]);
+    __read(proc, 0, 2, 399, &b[2]);
+    __read(proc, 0, 2, 400, &b[3]);
+    int pass3 = (r3 == 0 && b[0] == (BYTE)(7 + 99) && b[1] == (BYTE)0xAA &&
+                 b[2] == (BYTE)0xAA && b[3] == (BYTE)(7 + 400));
+    sprintf(expected, "0x6a 0xaa 0xaa 0x97");
+    sprintf(actual, "0x%02x 0x%02x 0x%02x 0x%02x", (unsigned char)b[0], (unsigned char)b[1],
+            (unsigned char)b[2], (unsigned char)b[3]);
+    print_result("Block I/O - memset", expected, actual, pass3);
+
+    // Test 18.4: Blocks must stay within their region
+    int r4 = libreadblk(proc, 2, 0, 600);
+    int r5 = libreadblk(proc, 2, 1, 600);
+    int pass4 = (r4 == 0 && r5 != 0);
+    sprintf(expected, "readblk returns 0, then an error past the region");
+    sprintf(actual, "readblk returns %d, then %d", r4, r5);
+    print_result("Block I/O - Region bounds", expected, actual, pass4);
+
+    cleanup_test_process(proc, 1);
+    return (pass1 && pass2 && pass3 && pass4);
+}
+
+/* Test 19: Page replacement - a full MEMRAM swaps the victim out */
+int test_victim_swap() {
+    printf("\n%s=== Running test: Victim Swap ===%s\n", YELLOW, RESET);
+
+    struct pcb_t *proc = setup_test_process(1);
+    char expected[128], actual[128];
+    int nr_frames = proc->mram->maxsz / PAGING_PAGESZ;
+    int vicpgn = -1, pgn, free_frames = 0, dup = 0;
+    BYTE b = 0;
+
+    // Test 19.1: Fill MEMRAM, then fault on a page outside the region
+    pthread_mutex_lock(&mmvm_lock);
+    int a1 = liballoc(proc, nr_frames * PAGING_PAGESZ, 1);
+    pthread_mutex_unlock(&mmvm_lock);
+    for (pgn = 0; pgn < nr_frames; pgn++)
+        __write(proc, 0, 1, pgn * PAGING_PAGESZ, pgn + 1);
+    int r1 = __read(proc, 0, 1, nr_frames * PAGING_PAGESZ, &b);
+    for (pgn = 0; pgn < nr_frames; pgn++)
+        if (proc->mm->pgd[pgn] & PAGING_PTE_SWAPPED_MASK)
+            vicpgn = pgn;
+    int pass1 = (a1 == 0 && r1 == 0 && vicpgn >= 0);
+    sprintf(expected, "fault served, one page swapped out");
+    sprintf(actual, "alloc %d, getpage %d, victim page %d", a1, r1, vicpgn);
+    print_result("Victim Swap - Fault on a full MEMRAM", expected, actual, pass1);
+
+    // Test 19.2: The victim comes back from MEMSWAP with its content
+    int r2 = (vicpgn >= 0) ? __read(proc, 0, 1, vicpgn * PAGING_PAGESZ, &b) : -1;
+    int pass2 = (r2 == 0 && b == vicpgn + 1);
+    sprintf(expected, "value %d", vicpgn + 1);
+    sprintf(actual, "value %d", b);
+    print_result("Victim Swap - Swap in", expected, actual, pass2);
+
+    // Test 19.3: At exit every frame goes back to MEMRAM once
+    free_pcb_memph(proc);
+    struct framephy_struct *it, *jt;
+    for (it = proc->mram->free_fp_list; it != NULL; it = it->fp_next) {
+        free_frames++;
+        for (jt = it->fp_next; jt != NULL; jt = jt->fp_next)
+            if (jt->fpn == it->fpn)
+                dup++;
+    }
+    int pass3 = (free_frames == nr_frames && dup == 0);
+    sprintf(expected, "%d free frames, 0 duplicates", nr_frames);
+    sprintf(actual, "%d free frames, %d duplicates", free_frames, dup);
+    print_result("Victim Swap - Frames freed once", expected, actual, pass3);
+
+    cleanup_test_process(proc, 1);
+    return (pass1 && pass2 && pass3);
+}
+
 int main() {
     int your_log = open("log_mem.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (your_log == -1) {
@@ -1245,6 +1412,9 @@ int main() {
     int test14 = test_multiple_vma_management();
     int test15 = test_error_handling();
     int test16 = test_memory_stress();
+    int test17 = test_tlb();
+    int test18 = test_block_io();
+    int test19 = test_victim_swap();
 
     // Khôi phục stdout gốc
     dup2(stdout_backup, STDOUT_FILENO);
@@ -1270,9 +1440,12 @@ int main() {
     printf("Test Multiple VMAs:        %s%s%s\n", test14 ? GREEN : RED, test14 ? "PASSED" : "FAILED", RESET);
     printf("Test Error Handling:       %s%s%s\n", test15 ? GREEN : RED, test15 ? "PASSED" : "FAILED", RESET);
     printf("Test Memory Stress:        %s%s%s\n", test16 ? GREEN : RED, test16 ? "PASSED" : "FAILED", RESET);
+    printf("Test TLB:                  %s%s%s\n", test17 ? GREEN : RED, test17 ? "PASSED" : "FAILED", RESET);
+    printf("Test Block I/O:            %s%s%s\n", test18 ? GREEN : RED, test18 ? "PASSED" : "FAILED", RESET);
+    printf("Test Victim Swap:          %s%s%s\n", test19 ? GREEN : RED, test19 ? "PASSED" : "FAILED", RESET);
     
     int all_passed = test1 && test2 && test3 && test4 && test5 && test6 && test7 && test8 &&
-                    test9 && test10 && test11 && test12 && test13 && test14 && test15 && test16;
+                    test9 && test10 && test11 && test12 && test13 && test14 && test15 && test16 && test17 && test18 && test19;
     
     printf("\n%s===========================%s\n", YELLOW, RESET);
     printf("Overall result: %s%s%s\n", all_passed ? GREEN : RED, 
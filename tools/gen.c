@@ -0,0 +1,299 @@
+/*
+ * gen - generate synthetic workloads: a configure file in input/ and the
+ * programs it runs in input/proc/[name]/, drawn from the distributions
+ * given as options. The same options and seed give the same files.
+ *
+ * Usage: gen [name] [key=value ...]
+ *   seed=N             seed of the generator (default 1)
+ *   procs=N            processes to run (default 100)
+ *   programs=N         distinct programs they share (default 16)
+ *   cpus=N slot=N      CPUs and time slot of the configure file (4, 2)
+ *   rate=R             mean arrivals per time slot, the gaps between two
+ *                      arrivals are exponential (default 1)
+ *   prio=LO-HI         priorities drawn uniformly in [LO, HI], or
+ *   prio=P:W,P:W,...   priority P with weight W (default 0-139)
+ *   len=MIN-MAX        instructions of the body of a program (20-50)
+ *   mix=calc:W,alloc:W,read:W,write:W,syscall:W
+ *                      weights of the instructions of the body, missing
+ *                      ones are 0 (default calc:40,alloc:10,read:25,
+ *                      write:25). An alloc frees a region and allocates
+ *                      it again, a syscall sleeps 1 to 3 slots
+ *   ws=BYTES           working set of a program, allocated up front in
+ *                      [regions] regions that reads and writes spread
+ *                      over (default 1024)
+ *   regions=N          (default 4)
+ *   ram=BYTES swap=BYTES
+ *                      MEMRAM and MEMSWAP sizes (1048576, 16777216)
+ *   manifest=0|1       list the processes in input/[name].manifest and
+ *                      point the configure file at it (default 0)
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define MAX_PRIO	140
+#define MAX_REGIONS	20	/* Below PAGING_MAX_SYMTBL_SZ */
+#define MAX_WEIGHTS	MAX_PRIO
+
+enum { GEN_CALC, GEN_ALLOC, GEN_READ, GEN_WRITE, GEN_SYSCALL, NR_GEN_OPS };
+
+static const char * const op_names[NR_GEN_OPS] = {
+	"calc", "alloc", "read", "write", "syscall",
+};
+
+static uint64_t seed = 1;
+static int procs = 100, programs = 16, cpus = 4, slot = 2;
+static double rate = 1.0;
+static int prio_lo = 0, prio_hi = MAX_PRIO - 1;
+static int prio_val[MAX_WEIGHTS], prio_weight[MAX_WEIGHTS], nr_prio = 0;
+static int len_min = 20, len_max = 50;
+static int mix[NR_GEN_OPS] = { 40, 10, 25, 25, 0 };
+static int ws = 1024, regions = 4;
+static long ram = 1048576, swap = 16777216;
+static int use_manifest = 0;
+
+/* splitmix64, so a seed gives the same workload everywhere */
+static uint64_t next_rand(void) {
+	uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* Uniform in [lo, hi] */
+static int rand_range(int lo, int hi) {
+	return lo + (int)(next_rand() % (uint64_t)(hi - lo + 1));
+}
+
+/* Uniform in [0, 1) */
+static double rand_unit(void) {
+	return (next_rand() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Index drawn from [n] weights */
+static int rand_weighted(const int * weight, int n) {
+	int i, total = 0, r;
+	for (i = 0; i < n; i++)
+		total += weight[i];
+	r = rand_range(0, total - 1);
+	for (i = 0; r >= weight[i]; i++)
+		r -= weight[i];
+	return i;
+}
+
+static void usage_error(const char * opt, const char * why) {
+	printf("Invalid option '%s', %s\n", opt, why);
+	exit(1);
+}
+
+static void parse_range(const char * opt, const char * val, int * lo, int * hi) {
+	if (sscanf(val, "%d-%d", lo, hi) != 2 || *lo < 0 || *lo > *hi)
+		usage_error(opt, "expected LO-HI");
+}
+
+static void parse_prio(const char * opt, const char * val) {
+	char buf[1024], * tok;
+	int total = 0;
+	if (strchr(val, ':') == NULL) {
+		parse_range(opt, val, &prio_lo, &prio_hi);
+		if (prio_hi >= MAX_PRIO)
+			usage_error(opt, "priorities go up to 139");
+		nr_prio = 0;
+		return;
+	}
+	snprintf(buf, sizeof(buf), "%s", val);
+	nr_prio = 0;
+	for (tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		if (nr_prio == MAX_WEIGHTS ||
+		    sscanf(tok, "%d:%d", &prio_val[nr_prio], &prio_weight[nr_prio]) != 2 ||
+		    prio_val[nr_prio] < 0 || prio_val[nr_prio] >= MAX_PRIO ||
+		    prio_weight[nr_prio] < 0)
+			usage_error(opt, "expected PRIO:WEIGHT,...");
+		total += prio_weight[nr_prio++];
+	}
+	if (total == 0)
+		usage_error(opt, "no priority has a weight");
+}
+
+static void parse_mix(const char * opt, const char * val) {
+	char buf[1024], name[16], * tok;
+	int i, w, total = 0;
+	snprintf(buf, sizeof(buf), "%s", val);
+	memset(mix, 0, sizeof(mix));
+	for (tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+		if (sscanf(tok, "%15[^:]:%d", name, &w) != 2 || w < 0)
+			usage_error(opt, "expected OPCODE:WEIGHT,...");
+		for (i = 0; i < NR_GEN_OPS && strcmp(name, op_names[i]); i++)
+			;
+		if (i == NR_GEN_OPS)
+			usage_error(opt, "opcodes are calc, alloc, read, write and syscall");
+		mix[i] = w;
+		total += w;
+	}
+	if (total == 0)
+		usage_error(opt, "no instruction has a weight");
+}
+
+static void set_option(const char * opt) {
+	char key[32], val[1024];
+	if (sscanf(opt, "%31[^=]=%1023s", key, val) != 2)
+		usage_error(opt, "expected key=value");
+	if (!strcmp(key, "seed")) {
+		seed = strtoull(val, NULL, 10);
+	}else if (!strcmp(key, "procs")) {
+		procs = atoi(val);
+	}else if (!strcmp(key, "programs")) {
+		programs = atoi(val);
+	}else if (!strcmp(key, "cpus")) {
+		cpus = atoi(val);
+	}else if (!strcmp(key, "slot")) {
+		slot = atoi(val);
+	}else if (!strcmp(key, "rate")) {
+		rate = atof(val);
+	}else if (!strcmp(key, "prio")) {
+		parse_prio(opt, val);
+	}else if (!strcmp(key, "len")) {
+		parse_range(opt, val, &len_min, &len_max);
+	}else if (!strcmp(key, "mix")) {
+		parse_mix(opt, val);
+	}else if (!strcmp(key, "ws")) {
+		ws = atoi(val);
+	}else if (!strcmp(key, "regions")) {
+		regions = atoi(val);
+	}else if (!strcmp(key, "ram")) {
+		ram = atol(val);
+	}else if (!strcmp(key, "swap")) {
+		swap = atol(val);
+	}else if (!strcmp(key, "manifest")) {
+		use_manifest = atoi(val);
+	}else{
+		printf("Unknown option '%s'\n", opt);
+		exit(1);
+	}
+	if (procs < 1 || programs < 1 || cpus < 1 || slot < 1 || rate <= 0 ||
+	    ws < 1 || regions < 1 || regions > MAX_REGIONS ||
+	    ram < 1 || ram > INT32_MAX || swap < 0 || swap > INT32_MAX)
+		usage_error(opt, "out of range");
+}
+
+static int draw_prio(void) {
+	if (nr_prio > 0)
+		return prio_val[rand_weighted(prio_weight, nr_prio)];
+	return rand_range(prio_lo, prio_hi);
+}
+
+static FILE * open_out(const char * path) {
+	FILE * file;
+	if ((file = fopen(path, "w")) == NULL) {
+		printf("Cannot write %s\n", path);
+		exit(1);
+	}
+	return file;
+}
+
+/*
+ * Write one program: allocate the working set, run [len] instructions of
+ * the mix over it, then free it
+ */
+static void write_program(const char * path) {
+	int size[MAX_REGIONS], cap = (ws + regions - 1) / regions;
+	int len = rand_range(len_min, len_max), n = 0, i, r;
+	char * body = NULL;
+	size_t body_len = 0;
+	FILE * text = open_memstream(&body, &body_len);
+	FILE * file;
+
+	for (r = 0; r < regions; r++) {
+		size[r] = cap;
+		fprintf(text, "alloc %d %d\n", cap, r);
+		n++;
+	}
+	for (i = 0; i < len; i++) {
+		r = rand_range(0, regions - 1);
+		switch (rand_weighted(mix, NR_GEN_OPS)) {
+		case GEN_CALC:
+			fprintf(text, "calc\n");
+			break;
+		case GEN_ALLOC:
+			size[r] = rand_range(1, cap);
+			fprintf(text, "free %d\nalloc %d %d\n", r, size[r], r);
+			n++;
+			break;
+		case GEN_READ:
+			fprintf(text, "read %d %d %d\n", r, rand_range(0, size[r] - 1), r);
+			break;
+		case GEN_WRITE:
+			fprintf(text, "write %d %d %d\n", rand_range(0, 255), r,
+				rand_range(0, size[r] - 1));
+			break;
+		case GEN_SYSCALL:
+			fprintf(text, "syscall 404 %d\n", rand_range(1, 3));
+			break;
+		}
+		n++;
+	}
+	for (r = 0; r < regions; r++) {
+		fprintf(text, "free %d\n", r);
+		n++;
+	}
+	fclose(text);
+
+	file = open_out(path);
+	fprintf(file, "%d %d\n%s", draw_prio(), n, body);
+	fclose(file);
+	free(body);
+}
+
+int main(int argc, char * argv[]) {
+	char path[300], dir[256];
+	const char * name;
+	double t = 0;
+	unsigned long last = 0;
+	int i;
+	FILE * cfg, * list;
+
+	if (argc < 2 || strchr(argv[1], '=') != NULL) {
+		printf("Usage: gen [name] [key=value ...]\n");
+		return 1;
+	}
+	name = argv[1];
+	/* [name]/p[N] must fit a program name of a binary manifest */
+	if (strlen(name) > 20) {
+		printf("Workload name %s is longer than 20 characters\n", name);
+		return 1;
+	}
+	for (i = 2; i < argc; i++)
+		set_option(argv[i]);
+
+	snprintf(dir, sizeof(dir), "input/proc/%s", name);
+	mkdir(dir, 0755);
+	for (i = 0; i < programs; i++) {
+		snprintf(path, sizeof(path), "%s/p%d", dir, i);
+		write_program(path);
+	}
+
+	snprintf(path, sizeof(path), "input/%s", name);
+	cfg = open_out(path);
+	fprintf(cfg, "%d %d %d", slot, cpus, procs);
+	if (use_manifest) {
+		snprintf(path, sizeof(path), "input/%s.manifest", name);
+		fprintf(cfg, " manifest=%s", path);
+	}
+	fprintf(cfg, "\n%ld %ld 0 0 0\n", ram, swap);
+	list = use_manifest ? open_out(path) : cfg;
+	for (i = 0; i < procs; i++) {
+		last = (unsigned long)t;
+		fprintf(list, "%lu %s/p%d %d\n", last, name,
+			rand_range(0, programs - 1), draw_prio());
+		t += -log(1.0 - rand_unit()) / rate;
+	}
+	if (list != cfg)
+		fclose(list);
+	fclose(cfg);
+	printf("Wrote input/%s: %d processes of %d programs up to slot %lu\n",
+		name, procs, programs, last);
+	return 0;
+}
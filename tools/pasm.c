@@ -0,0 +1,60 @@
+/*
+ * pasm - compile text programs of input/proc into binary images the
+ * loader maps instead of parsing, see include/image.h, and text process
+ * manifests into binary ones, see include/manifest.h
+ *
+ * Usage: pasm [program] [image]
+ *        pasm -d [directory] [program ...]
+ *        pasm -m [manifest] [binary manifest]
+ * The second form writes [directory]/[name of program] for each program.
+ */
+#include "image.h"
+#include "manifest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void compile(const char * src, const char * dst) {
+	struct code_seg_t code;
+	uint32_t priority;
+	FILE * file;
+	if ((file = fopen(src, "r")) == NULL) {
+		printf("Cannot find process description at '%s'\n", src);
+		exit(1);
+	}
+	read_program(file, src, &priority, &code);
+	fclose(file);
+	if (write_image(dst, priority, &code) != 0) {
+		printf("Cannot write image '%s'\n", dst);
+		exit(1);
+	}
+	free(code.text);
+}
+
+int main(int argc, char * argv[]) {
+	int i;
+	if (argc == 4 && !strcmp(argv[1], "-m")) {
+		if (compile_manifest(argv[2], argv[3]) != 0) {
+			printf("Cannot write manifest '%s'\n", argv[3]);
+			exit(1);
+		}
+		return 0;
+	}
+	if (argc == 3 && argv[1][0] != '-') {
+		compile(argv[1], argv[2]);
+		return 0;
+	}
+	if (argc < 4 || strcmp(argv[1], "-d") != 0) {
+		printf("Usage: pasm [program] [image]\n"
+		       "       pasm -d [directory] [program ...]\n"
+		       "       pasm -m [manifest] [binary manifest]\n");
+		return 1;
+	}
+	for (i = 3; i < argc; i++) {
+		char dst[256];
+		const char * name = strrchr(argv[i], '/');
+		snprintf(dst, sizeof(dst), "%s/%s", argv[2], name ? name + 1 : argv[i]);
+		compile(argv[i], dst);
+	}
+	return 0;
+}